@@ -0,0 +1,23 @@
+#ifndef COMMAND_UDP_H
+#define COMMAND_UDP_H
+
+#include <stdint.h>
+
+//* ************************************************************************
+//* *************************** COMMAND UDP ********************************
+//* ************************************************************************
+//! The serial command set over UDP, for tuning from a laptop on the shop
+//! network: one command per datagram, the reply goes back to the sender.
+//!
+//!   echo "set feedTime 2300" | nc -u -w1 <router-ip> 4210
+
+namespace CommandUdp {
+
+const uint16_t PORT = 4210;
+
+void begin();    // Start listening; call once the network is up
+void poll();     // Handle waiting datagrams; network task only
+
+} // namespace CommandUdp
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef CONTROL_TASK_H
+#define CONTROL_TASK_H
+
+#include <stdint.h>
+#include "TickStats.h"
+
+//* ************************************************************************
+//* ************************** CONTROL TASK ********************************
+//* ************************************************************************
+//! Runs inputs + state machine at a fixed CONTROL_TICK_HZ in a FreeRTOS task
+//! pinned to the application core, away from WiFi/OTA on the protocol core.
+//! Stops ticking while every lane is idle with nothing to do.
+
+// Idle sleeps since boot
+struct IdleStats {
+    uint32_t sleeps;        // Idle spells the task slept through
+    uint32_t sleptMs;       // Total time spent in them
+    uint32_t inputWakes;    // Spells ended by a start input edge
+    uint32_t lastWakeUs;    // Input edge to the task running, last input wake
+    uint32_t maxWakeUs;     // ...worst since boot
+};
+
+namespace ControlTask {
+
+void start();
+
+// Last completed jitter window, safe to call from any task
+TickStats lastWindow();
+
+// Idle sleep counters and wake latency, safe to call from any task
+IdleStats idleStats();
+
+} // namespace ControlTask
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef DELTA_OTA_H
+#define DELTA_OTA_H
+
+#include <stdint.h>
+
+//* ************************************************************************
+//* **************************** DELTA OTA *********************************
+//* ************************************************************************
+//! Firmware updates as a patch against the running image instead of a full
+//! upload (format in DeltaPatch.h). A 1 MB image that changed by a few
+//! functions ships as a few KB, so the machine is held for seconds, not
+//! the better part of a minute:
+//!
+//!   tools/delta_ota/delta_ota diff old.bin new.bin update.rdp
+//!   tools/delta_ota/delta_ota send update.rdp <router-ip>
+//!
+//! The machine finishes its current cycle first: the patch is only read
+//! once every lane is idle or faulted, then applied straight into the next
+//! OTA partition as it arrives. Both the base image and the result are SHA-256 checked; the
+//! boot partition only switches after the result verifies, and the reboot
+//! waits until the machine is back in IDLE.
+
+namespace DeltaOta {
+
+const uint16_t PORT = 3233;
+
+void begin();    // Start listening; call once the network is up
+void poll();     // Accept and stream a patch; network task only
+
+} // namespace DeltaOta
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef DELTA_PATCH_H
+#define DELTA_PATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Sha256.h"
+
+//* ************************************************************************
+//* ************************* DELTA PATCH FORMAT ***************************
+//* ************************************************************************
+//! A patch rebuilds the new firmware image front to back from the running
+//! (old) image plus literal bytes. Little-endian throughout.
+//!
+//!   header (80 bytes):
+//!     magic u32 "RDP1" | version u8 | reserved u8 x3
+//!     old size u32 | new size u32 | old SHA-256 [32] | new SHA-256 [32]
+//!   ops, until END:
+//!     COPY   0x01 | old offset u32 | length u32     bytes from the old image
+//!     INSERT 0x02 | length u32 | bytes               literal bytes
+//!     END    0x00
+//!
+//! Built by tools/delta_ota; applied on the device by PatchApplier.
+
+const uint32_t PATCH_MAGIC = 0x31504452;   // "RDP1"
+const uint8_t PATCH_VERSION = 1;
+const size_t PATCH_HEADER_SIZE = 80;
+
+enum PatchOp : uint8_t { PATCH_END = 0x00, PATCH_COPY = 0x01, PATCH_INSERT = 0x02 };
+
+struct PatchHeader {
+    uint32_t oldSize;
+    uint32_t newSize;
+    uint8_t oldHash[Sha256::DIGEST_SIZE];
+    uint8_t newHash[Sha256::DIGEST_SIZE];
+};
+
+// Where the old image is read from (random access)
+class PatchSource {
+public:
+    virtual ~PatchSource() = default;
+    virtual bool read(uint32_t offset, uint8_t* data, size_t length) = 0;
+};
+
+// Where the new image is written (strictly sequential)
+class PatchSink {
+public:
+    virtual ~PatchSink() = default;
+    virtual bool begin(uint32_t imageSize) = 0;   // Called once the header is known
+    virtual bool write(const uint8_t* data, size_t length) = 0;
+};
+
+//* ************************************************************************
+//* ************************** PATCH APPLIER *******************************
+//* ************************************************************************
+//! Streaming patch applier: feed() the patch in chunks of any size, as they
+//! arrive. RAM use is fixed (the header, one op and a COPY_BUFFER-byte copy
+//! buffer), whatever the image size. The old image is hashed and checked
+//! against the header before anything is written, and the new image is
+//! hashed as it is written; DONE is only returned if that hash matches.
+
+class PatchApplier {
+public:
+    enum Status : uint8_t {
+        PATCH_NEED_MORE,         // Keep feeding
+        PATCH_DONE,              // Image complete and verified
+        PATCH_BAD_HEADER,
+        PATCH_WRONG_BASE,        // Old image is not the one the patch was made from
+        PATCH_BAD_OP,
+        PATCH_OUT_OF_RANGE,      // COPY outside the old image, or output past the new size
+        PATCH_IO_ERROR,          // Source read or sink write failed
+        PATCH_HASH_MISMATCH,     // Rebuilt image doesn't match the header
+        PATCH_TRAILING_DATA,
+    };
+
+    static const size_t COPY_BUFFER = 512;
+
+    PatchApplier(PatchSource& oldImage, PatchSink& newImage);
+
+    Status feed(const uint8_t* data, size_t length);
+    Status status() const { return current; }
+    const PatchHeader& header() const { return hdr; }
+    uint32_t bytesWritten() const { return written; }
+
+    static const char* statusText(Status status);
+
+private:
+    enum Phase : uint8_t { PH_HEADER, PH_OP, PH_OP_ARGS, PH_INSERT_DATA, PH_FINISHED };
+
+    PatchSource& source;
+    PatchSink& sink;
+    Sha256 newHash;
+    PatchHeader hdr;
+    Status current;
+    Phase phase;
+
+    uint8_t pending[PATCH_HEADER_SIZE];   // Header or op arguments being collected
+    size_t pendingLength;
+    size_t pendingNeeded;
+    uint8_t op;
+    uint32_t insertRemaining;
+    uint32_t written;
+    uint8_t copyBuffer[COPY_BUFFER];
+
+    Status fail(Status status);
+    Status parseHeader();
+    Status runOp();
+    Status emit(const uint8_t* data, size_t length);
+    Status finish();
+};
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef EDGE_INPUT_H
+#define EDGE_INPUT_H
+
+#include <atomic>
+#include "hal/Hal.h"
+#include "SpscQueue.h"
+
+//* ************************************************************************
+//* ************************ EDGE-INTERRUPT INPUT **************************
+//* ************************************************************************
+//! Digital input driven by a pin-change interrupt instead of polling. The
+//! ISR only timestamps the edge (microseconds) and queues it; debouncing
+//! happens on those timestamps in update(), on the control task.
+//!
+//! Debounce is leading-edge with a lockout: the first edge that changes the
+//! level is accepted at its own timestamp, and further edges within
+//! DEBOUNCE_US of it are treated as bounce. Once the lockout has passed,
+//! a pin that settled on the other level (trailing edge lost in the bounce
+//! or a full queue) is reconciled at the time of its last raw edge.
+
+struct RawEdge {
+    uint32_t timeUs;
+    bool level;
+};
+
+// Called from ISR context after every queued edge (e.g. to wake the
+// control task early). Must be ISR-safe and placed in IRAM on target.
+typedef void (*EdgeWakeHook)();
+extern EdgeWakeHook edgeWakeHook;
+
+// A debounced input as the step code sees it: plain data, copied out of
+// the lane's EdgeInput<PIN> on every update, so reading it is a load
+// whichever pin and lane it came from.
+struct InputState {
+    bool level;
+    bool changed;              // Level changed on the last update
+    uint32_t edgeUs;           // When the current level began
+
+    bool read() const { return level; }
+    bool rose() const { return changed && level; }
+    bool fell() const { return changed && !level; }
+    uint32_t edgeTimeUs() const { return edgeUs; }
+};
+
+template <int PIN, uint32_t DEBOUNCE_US>
+class EdgeInput {
+private:
+    static const uint32_t QUEUE_SIZE = 16;
+
+    SpscQueue<RawEdge, QUEUE_SIZE> rawEdges;   // ISR -> control task
+    std::atomic<uint32_t> overflows;
+    InputState current;     // edgeUs is the timestamp of the last accepted edge
+    uint32_t lastRawUs;     // Timestamp of the last raw edge seen
+
+    static void HAL_ISR_ATTR onEdge(void* arg) {
+        EdgeInput* self = static_cast<EdgeInput*>(arg);
+        const RawEdge edge = { hal::Clock::micros(), hal::InputPin<PIN>::read() };
+        if (!self->rawEdges.push(edge)) self->overflows.fetch_add(1, std::memory_order_relaxed);
+        if (edgeWakeHook) edgeWakeHook();
+    }
+
+    bool accept(uint32_t timeUs, bool level) {
+        current.level = level;
+        current.edgeUs = timeUs;
+        current.changed = true;
+        return true;
+    }
+
+public:
+    EdgeInput() : overflows(0), current(), lastRawUs(0) {}
+
+    void begin(hal::Pull pull) {
+        hal::InputPin<PIN>::begin(pull);
+        current.level = hal::InputPin<PIN>::read();
+        current.changed = false;
+        current.edgeUs = lastRawUs = hal::Clock::micros() - DEBOUNCE_US;
+        rawEdges.clear();
+        hal::gpio::attachEdgeInterrupt(PIN, onEdge, this);
+    }
+
+    // Consume queued edges; returns true when the debounced level changed.
+    // Stops at the first accepted change so every change is observed.
+    bool update() {
+        current.changed = false;
+
+        RawEdge edge;
+        while (rawEdges.pop(edge)) {
+            lastRawUs = edge.timeUs;
+            if (edge.level != current.level && edge.timeUs - current.edgeUs >= DEBOUNCE_US) {
+                return accept(edge.timeUs, edge.level);
+            }
+        }
+
+        const uint32_t now = hal::Clock::micros();
+        if (now - current.edgeUs >= DEBOUNCE_US && now - lastRawUs >= DEBOUNCE_US) {
+            const bool level = hal::InputPin<PIN>::read();
+            if (level != current.level) return accept(lastRawUs, level);
+        }
+        return false;
+    }
+
+    const InputState& state() const { return current; }
+    uint32_t overflowCount() const { return overflows.load(std::memory_order_relaxed); }
+};
+
+// Stand-in for an input that isn't fitted: never active, never changes
+struct NoEdgeInput {
+    void begin(hal::Pull) {}
+    bool update() { return false; }
+    InputState state() const { return InputState(); }
+    uint32_t overflowCount() const { return 0; }
+};
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+//* ************************************************************************
+//* ********************** LOG-BUCKETED HISTOGRAM **************************
+//* ************************************************************************
+//! Fixed-size histogram of durations in microseconds. Values below
+//! 2^SUB_BITS get their own bucket; above that every power of two is split
+//! into 2^SUB_BITS equal buckets, so a bucket is never wider than
+//! 1/2^SUB_BITS of its values (6.25% at the default of 4) across the whole
+//! uint32 range. Percentiles interpolate inside the bucket and are clamped
+//! to the observed min/max. record() is a handful of integer operations
+//! with no allocation, cheap enough for every control tick.
+//!
+//! One writer. Readers on other tasks may see a record half-applied
+//! (count updated, bucket not yet); that only skews a snapshot by one sample.
+
+template <int SUB_BITS = 4>
+class LogHistogram {
+    static_assert(SUB_BITS >= 1 && SUB_BITS <= 8, "LogHistogram SUB_BITS out of range");
+
+public:
+    static const int SUB_BUCKETS = 1 << SUB_BITS;                    // Per power of two
+    static const int BUCKETS = (32 - SUB_BITS + 1) * SUB_BUCKETS;    // Covers 0 .. UINT32_MAX
+
+    LogHistogram() { reset(); }
+
+    void reset() {
+        for (int i = 0; i < BUCKETS; i++) buckets[i] = 0;
+        samples = 0;
+        minValue = UINT32_MAX;
+        maxValue = 0;
+        sum = 0;
+    }
+
+    void record(uint32_t value) {
+        buckets[bucketOf(value)]++;
+        samples++;
+        sum += value;
+        if (value < minValue) minValue = value;
+        if (value > maxValue) maxValue = value;
+    }
+
+    uint32_t count() const { return samples; }
+    uint32_t min() const { return samples ? minValue : 0; }
+    uint32_t max() const { return maxValue; }
+    uint32_t mean() const { return samples ? (uint32_t)(sum / samples) : 0; }
+
+    // Value at or below which `permille`/1000 of the samples fall (e.g. 990
+    // for p99), interpolated inside its bucket
+    uint32_t percentile(uint32_t permille) const {
+        if (samples == 0) return 0;
+        uint64_t rank = ((uint64_t)samples * permille + 999) / 1000;
+        if (rank == 0) rank = 1;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            if (buckets[i] == 0) continue;
+            if (seen + buckets[i] >= rank) {
+                const uint64_t lower = lowerBound(i);
+                const uint64_t width = upperBound(i) - lower + 1;
+                uint64_t value = lower + width * (rank - seen) / buckets[i] - 1;
+                if (value < minValue) value = minValue;
+                if (value > maxValue) value = maxValue;
+                return (uint32_t)value;
+            }
+            seen += buckets[i];
+        }
+        return maxValue;
+    }
+
+    static int bucketOf(uint32_t value) {
+        if (value < (uint32_t)SUB_BUCKETS) return (int)value;
+        const int msb = 31 - __builtin_clz(value);
+        const int sub = (int)(value >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1);
+        return (msb - SUB_BITS + 1) * SUB_BUCKETS + sub;
+    }
+
+    static uint32_t lowerBound(int bucket) {
+        if (bucket < SUB_BUCKETS) return (uint32_t)bucket;
+        const int msb = bucket / SUB_BUCKETS + SUB_BITS - 1;
+        const int sub = bucket % SUB_BUCKETS;
+        return (uint32_t)((uint64_t)(SUB_BUCKETS + sub) << (msb - SUB_BITS));
+    }
+
+    static uint32_t upperBound(int bucket) {
+        if (bucket < SUB_BUCKETS) return (uint32_t)bucket;
+        const int msb = bucket / SUB_BUCKETS + SUB_BITS - 1;
+        return (uint32_t)(lowerBound(bucket) + ((uint64_t)1 << (msb - SUB_BITS)) - 1);
+    }
+
+private:
+    uint32_t buckets[BUCKETS];
+    uint32_t samples;
+    uint32_t minValue;
+    uint32_t maxValue;
+    uint64_t sum;
+};
+
+// Step, state and cycle durations
+typedef LogHistogram<> Histogram;
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef LOG_EVENTS_H
+#define LOG_EVENTS_H
+
+#include <stdint.h>
+
+//* ************************************************************************
+//* *************************** LOG EVENTS ********************************
+//* ************************************************************************
+//! Every message the control path can log, as (id, printf format). The
+//! format receives the record's two int32 arguments (arg0, arg1) and is
+//! only expanded by the drain task, never on the control path.
+
+#define LOG_EVENTS(X) \
+    X(EV_IDLE_WAITING,          "State: IDLE - Waiting for start signal...") \
+    X(EV_START_SIGNAL,          "Start signal received! Transitioning to FEEDING state.") \
+    X(EV_FEED1_WAIT_DELAY,      "State: FEEDING - Step 1: Waiting for start delay...") \
+    X(EV_FEED1_DELAY_DONE,      "                 - Start delay complete. Retracting cylinder to push wood.") \
+    X(EV_FEED1_WAIT_FEED,       "State: FEEDING - Step 2: Waiting for the feed stroke to complete...") \
+    X(EV_FEED1_DONE,            "                 - Feed complete. Extending cylinder to safe position.\n" \
+                                "                 - Transitioning to FLIPPING state.") \
+    X(EV_FEED_STROKE_SENSED,    "                 - End of stroke after %ld ms (timeout now %ld ms).") \
+    X(EV_FEED_STROKE_MISSED,    "End-of-stroke switch not seen after %ld ms (%ld missed so far)") \
+    X(EV_FLIP_MOVE_OUT,         "State: FLIPPING - Step 1: Moving servo to flip position.") \
+    X(EV_FLIP_WAIT_OUT,         "State: FLIPPING - Step 2: Waiting for servo to finish moving.") \
+    X(EV_FLIP_REACHED_OUT,      "                 - Servo has reached flip position (%ld ms move, at %ld, 0.1 deg).") \
+    X(EV_FLIP_MOVE_HOME,        "State: FLIPPING - Step 3: Moving servo back to home position.") \
+    X(EV_FLIP_WAIT_HOME,        "State: FLIPPING - Step 4: Waiting for servo to return home.") \
+    X(EV_FLIP_REACHED_HOME,     "                 - Servo has returned home. Transitioning to FEEDING2 state.") \
+    X(EV_FLIP_OVERLAP_FEED2,    "                 - Servo past safe return angle (%ld, 0.1 deg). Starting FEEDING2 early.") \
+    X(EV_FEED2_START,           "State: FEEDING2 - Step 1: Starting second feed.") \
+    X(EV_FEED2_WAIT_FEED,       "State: FEEDING2 - Step 2: Waiting for the feed stroke to complete.") \
+    X(EV_FEED2_DONE,            "                 - Feed complete. Extending cylinder to safe position.\n" \
+                                "                 - Machine cycle complete. Returning to IDLE state.") \
+    X(EV_STEP_TIMEOUT,          "Step %ld still waiting after its %ld ms timeout") \
+    X(EV_PARAMS_APPLIED,        "Parameters: staged changes applied at cycle boundary") \
+    X(EV_SERVO_WRITE,           "Servo: Setting angle %ld (0.1 deg), duty=%ld") \
+    X(EV_SERVO_MOVE,            "Servo: Moving to %ld (0.1 deg), profile %ld ms") \
+    X(EV_TICK_JITTER,           "Control tick jitter: max %ld us, mean %ld us") \
+    X(EV_START_LATENCY,         "Start latency: edge to detect %ld us, edge to cylinder %ld us past start delay") \
+    X(EV_TICK_OVERRUN,          "Control tick overran its period %ld times (longest %ld us)") \
+    X(EV_TRIGGER_QUEUED,        "Start trigger latched mid-cycle (%ld waiting)") \
+    X(EV_TRIGGER_COALESCED,     "Start trigger %ld us after the last one, counted as the same part") \
+    X(EV_TRIGGER_DROPPED,       "Start trigger dropped: %ld already waiting (%ld dropped so far)") \
+    X(EV_TRIGGER_RESTART,       "Start trigger was waiting: next cycle starts on this tick") \
+    X(EV_TRIGGER_LEVEL,         "Start sensor already active with nothing queued: starting for the part on it") \
+    X(EV_FAULT_WATCHDOG,        "FAULT: step %ld passed its %ld ms watchdog deadline") \
+    X(EV_FAULT_FEED_JAM,        "FAULT: feed stroke did not reach the end-of-stroke switch in %ld ms (jam?)") \
+    X(EV_FAULT_SAFE,            "State: FAULT - Cylinder released, servo returning home.") \
+    X(EV_FAULT_RETRY_WAIT,      "                 - Automatic retry %ld in %ld ms.") \
+    X(EV_FAULT_LATCHED,         "                 - %ld retries used. Press start or send \"clear\" to resume.") \
+    X(EV_FAULT_RETRY,           "                 - Retrying the cycle (attempt %ld).") \
+    X(EV_FAULT_CLEARED,         "                 - Fault cleared by the operator.") \
+    X(EV_IDLE_SLEEP,            "Control task idle: ticks stop until an input, a command or a fault retry") \
+    X(EV_IDLE_WAKE,             "Control task awake after %ld ms idle, %ld us from input to running") \
+    X(EV_IDLE_WAKE_SLOW,        "Control task took %ld us from input to running (limit %ld us)") \
+    X(EV_LIGHT_SLEEP_OFF,       "Light sleep unavailable (error %ld); idle sleep keeps the CPU clocked")
+
+#define LOG_EVENT_ENUM(id, fmt) id,
+enum LogEvent : uint16_t { LOG_EVENTS(LOG_EVENT_ENUM) EV_COUNT };
+#undef LOG_EVENT_ENUM
+
+#endif
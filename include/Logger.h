@@ -0,0 +1,81 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+//* ************************************************************************
+//* ************************ RING BUFFER LOGGER ****************************
+//* ************************************************************************
+//! Non-blocking logger for the control path. Logging pushes a fixed-size
+//! binary record into a lock-free single-producer/single-consumer ring;
+//! a low-priority task drains the ring and does all of the text formatting.
+//! When the ring is full the record is dropped and counted, never waited on.
+//!
+//! Single producer: only the control path (state machine, servo) may log
+//! through here. Setup and network code keep using Serial directly.
+
+#include <stdint.h>
+#include "LogEvents.h"
+
+// --- COMPILE-TIME LOG LEVELS ---
+// Calls above LOG_LEVEL compile to nothing (arguments are not evaluated).
+// Override per environment with e.g. build_flags = -DLOG_LEVEL=LOG_LEVEL_WARN
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// One log entry: 16 bytes, no pointers to transient data
+struct LogRecord {
+    uint32_t timeUs;   // hal::Clock::micros() at the call site
+    uint8_t event;     // LogEvent id
+    uint8_t lane;      // Lane the event belongs to (LOG_NO_LANE if none)
+    uint8_t state;     // Lane state at the call site (0 if not applicable)
+    uint8_t step;      // Step within the state (0 if not applicable)
+    int32_t arg0;
+    int32_t arg1;
+};
+
+static_assert(EV_COUNT <= 256, "LogRecord stores the event id in one byte");
+
+const uint8_t LOG_NO_LANE = 0xFF;
+
+namespace Logger {
+
+const uint32_t RING_SIZE = 128; // Records; must be a power of two
+
+void init();                     // Start the drain task (target) / reset the ring
+bool push(uint16_t event, uint8_t lane, uint8_t state, uint8_t step, int32_t arg0 = 0, int32_t arg1 = 0);
+void drain();                    // Format and print everything queued so far
+uint32_t droppedCount();         // Records lost because the ring was full
+
+} // namespace Logger
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Logger::push(__VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) Logger::push(__VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) Logger::push(__VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Logger::push(__VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#endif
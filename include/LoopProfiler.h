@@ -0,0 +1,53 @@
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <stdint.h>
+#include "Histogram.h"
+#include "hal/Hal.h"
+
+//* ************************************************************************
+//* ************************** LOOP PROFILER *******************************
+//* ************************************************************************
+//! Where the firmware's polling loops spend their time. Each loop (the
+//! control tick and the network task) reports its iterations and their
+//! cost; the expensive calls inside them report per-section durations.
+//! Every loop and section has exactly one writing task: the loop's own.
+//! That task publishes a copy of its counters and sections once a second
+//! (and on publish()); readers on other tasks only ever see those copies.
+
+namespace LoopProfiler {
+
+enum Loop : uint8_t { LOOP_CONTROL, LOOP_NETWORK, LOOP_COUNT };
+enum Section : uint8_t { SEC_INPUTS, SEC_STATE_MACHINE, SEC_OTA, SEC_COUNT };
+
+struct LoopCounters {
+    uint32_t iterations;       // Since boot
+    uint32_t perSecond;        // Iterations in the last full second
+    uint32_t worstUs;          // Costliest iteration since boot
+    uint32_t windowStartUs;    // Writer only
+    uint32_t windowCount;      // Writer only
+};
+
+// Writer side, on the loop's own task
+void recordIteration(Loop loop, uint32_t costUs);
+void recordSection(Section section, uint32_t us);
+void publish(Loop loop);           // Publish now, e.g. before the task sleeps
+
+// Published copies; safe from any task. A Histogram is ~2 KB: keep `out`
+// in static storage, not on a stack.
+LoopCounters loopCounters(Loop loop);
+void readSection(Section section, Histogram& out);
+const char* loopName(Loop loop);
+const char* sectionName(Section section);
+
+// Time a call into a section: PROFILE_SECTION(SEC_OTA, handleOTA());
+#define PROFILE_SECTION(section, call) do {                                      \
+        const uint32_t profileStartUs_ = hal::Clock::micros();                    \
+        call;                                                                     \
+        LoopProfiler::recordSection(LoopProfiler::section,                        \
+                                    hal::Clock::micros() - profileStartUs_);      \
+    } while (0)
+
+} // namespace LoopProfiler
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef MOTION_PROFILE_H
+#define MOTION_PROFILE_H
+
+#include <stdint.h>
+
+//* ************************************************************************
+//* ************************* MOTION PROFILE *******************************
+//* ************************************************************************
+//! Rest-to-rest point move under velocity, acceleration and jerk limits.
+//! With a jerk limit the move is a 7-segment S-curve; with maxJerk = 0 it
+//! degrades to a trapezoid. Short moves that never reach maxVelocity get a
+//! reduced peak velocity so the limits still hold. Units are degrees and
+//! seconds; elapsed time is passed in microseconds.
+
+struct MotionLimits {
+    float maxVelocity;  // deg/s
+    float maxAccel;     // deg/s^2
+    float maxJerk;      // deg/s^3, 0 = unlimited (trapezoidal profile)
+};
+
+class MotionProfile {
+private:
+    struct Segment {
+        float duration;  // s
+        float p0;        // Distance travelled at segment start (deg)
+        float v0;        // Velocity at segment start (deg/s)
+        float a0;        // Acceleration at segment start (deg/s^2)
+        float jerk;      // Constant jerk over the segment (deg/s^3)
+    };
+
+    static const int MAX_SEGMENTS = 7;
+
+    Segment segments[MAX_SEGMENTS];
+    uint8_t segmentCount;
+    float startAngle;
+    float endAngle;
+    float direction;
+    uint32_t totalUs;
+
+    void addSegment(float duration, float a0, float jerk);
+
+public:
+    MotionProfile();
+
+    // Plan a move; a zero-length or limit-less move completes immediately
+    void plan(float fromAngle, float toAngle, const MotionLimits& limits);
+
+    float angleAt(uint32_t elapsedUs) const;
+    uint32_t durationUs() const { return totalUs; }
+    float targetAngle() const { return endAngle; }
+};
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef OTA_MANAGER_H
+#define OTA_MANAGER_H
+
+#include <stdint.h>
+
+//* ************************************************************************
+//* ************************** OTA MANAGER *********************************
+//* ************************************************************************
+//! WiFi + ArduinoOTA bring-up as a non-blocking state machine driven by the
+//! network task. initOTA() only kicks off the connection and returns.
+
+void initOTA();            // Start connecting; returns immediately
+void startNetworkTask();   // Drives the connection state machine on core 0
+void handleOTA();          // No-op until WiFi and OTA are up
+
+bool networkReady();       // WiFi connected and OTA listening
+uint32_t otaTimeToReadyMs();       // Boot to first ready, 0 until then
+uint32_t otaLastReconnectMs();     // Link loss to ready again, 0 if never lost
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <stdint.h>
+
+//* ************************************************************************
+//* ***************************** SEQLOCK **********************************
+//* ************************************************************************
+//! Lock-free handoff of a small struct from exactly one writer to any
+//! number of readers on other tasks/cores. The writer never waits; a reader
+//! that overlaps a write sees an odd or changed sequence and retries (or,
+//! with tryRead(), skips this round). T must be trivially copyable.
+
+template <typename T>
+class Seqlock {
+private:
+    std::atomic<uint32_t> sequence;
+    T value;
+
+public:
+    Seqlock() : sequence(0), value() {}
+
+    void write(const T& next) {
+        sequence.fetch_add(1, std::memory_order_acq_rel);   // Odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        value = next;
+        sequence.fetch_add(1, std::memory_order_release);   // Even: stable again
+    }
+
+    bool tryRead(T& out) const {
+        const uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) return false;
+        out = value;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    // Write in place, for a T too large to build on the stack and copy in
+    template <typename Fill>
+    void writeWith(Fill fill) {
+        sequence.fetch_add(1, std::memory_order_acq_rel);
+        std::atomic_thread_fence(std::memory_order_release);
+        fill(value);
+        sequence.fetch_add(1, std::memory_order_release);
+    }
+
+    T read() const {
+        T out;
+        while (!tryRead(out)) {}
+        return out;
+    }
+};
+
+#endif
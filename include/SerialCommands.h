@@ -0,0 +1,43 @@
+#ifndef SERIAL_COMMANDS_H
+#define SERIAL_COMMANDS_H
+
+//* ************************************************************************
+//* ************************* SERIAL COMMANDS ******************************
+//* ************************************************************************
+//! Line-based commands on the USB serial console, polled from the network
+//! task so reading and printing never touch the control core. The same
+//! commands are accepted over UDP (CommandUdp), replying to the sender.
+//!
+//!   stats                        Per-lane step, state and cycle-time percentiles, loop cost
+//!   params [lane]                Active and staged parameter values with their ranges
+//!   set [lane] <name> <value>    Stage a parameter change (applied at the lane's next cycle boundary)
+//!   defaults [lane]              Stage the Config.h defaults for every parameter
+//!   clear [lane]                 Acknowledge a fault; the lane goes back to IDLE
+//!   trace [now]                  Step transitions before the last reset (or so far this boot)
+//!
+//! Without a lane number, params/set/defaults apply to every lane.
+
+// Where a command's reply goes
+class CommandOutput {
+public:
+    virtual void write(const char* text) = 0;
+    void printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+namespace SerialCommands {
+
+void poll();                                        // Read pending input; run each complete line
+void execute(const char* line);                     // Run one command line, reply on serial
+void execute(const char* line, CommandOutput& out); // Run one command line, reply to `out`
+void printStats(CommandOutput& out);                // The "stats" snapshot
+void printTrace(CommandOutput& out, bool lastBoot);  // The "trace" dump
+
+// Appended to "stats" by the target build: tick jitter, idle sleep and
+// network timings, which only exist on the ESP32 (set before the network
+// task starts)
+typedef void (*StatsSection)(CommandOutput& out);
+extern StatsSection platformStats;
+
+} // namespace SerialCommands
+
+#endif
@@ -1,21 +1,83 @@
 #ifndef SERVO_CONTROL_H
 #define SERVO_CONTROL_H
 
-#include <Arduino.h>
+#include <atomic>
+#include "hal/Hal.h"
+#include "MotionProfile.h"
+#include "Seqlock.h"
+#include "ServoFeedback.h"
 
+//* ************************************************************************
+//* ********************** ANGLE TO PULSE TABLE ****************************
+//* ************************************************************************
+//! Pulse width for every whole degree, in 1/16 us, built at compile time
+//! from the servo's pulse-width and angle range. Fractional angles are
+//! linearly interpolated between entries, all in integer math.
+template <int MIN_US, int MAX_US, int MIN_DEG, int MAX_DEG>
+struct ServoPulseTable {
+    static_assert(MAX_DEG > MIN_DEG, "Servo angle range is empty");
+    static_assert(MAX_US > MIN_US && MAX_US * 16 <= 0xFFFF, "Servo pulse range does not fit the table");
+
+    static constexpr int MIN_ANGLE = MIN_DEG;
+    static constexpr int MAX_ANGLE = MAX_DEG;
+    static constexpr int SIZE = MAX_DEG - MIN_DEG + 1;
+
+    uint16_t pulseQ4[SIZE];
+
+    constexpr ServoPulseTable() : pulseQ4() {
+        for (int i = 0; i < SIZE; i++) {
+            const int span = MAX_DEG - MIN_DEG;
+            pulseQ4[i] = (uint16_t)(MIN_US * 16 + ((MAX_US - MIN_US) * 16 * i + span / 2) / span);
+        }
+    }
+};
+
+//* ************************************************************************
+//* ************************** SERVO CONTROL *******************************
+//* ************************************************************************
+//! write() jumps straight to an angle; moveTo() follows a jerk-limited
+//! motion profile. Either way the PWM duty is only written from update(),
+//! which a hardware timer calls once per PWM frame, so the control loop
+//! never touches the LEDC peripheral. Arrival is predicted from the
+//! profile model rather than a fixed delay, or measured when the servo has
+//! a position output (attachFeedback). pause() stops that timer while the
+//! arm is at rest; the next command restarts it.
 class ServoControl {
 private:
     int pin;
     int channel;
     int frequency;
     int resolution;
-    int minPulseWidth;
-    int maxPulseWidth;
-    int minAngle;
-    int maxAngle;
-    
-    int angleToDuty(float angle);
-    
+    uint32_t dutyPerUsQ16;  // Duty counts per microsecond of pulse, 16.16 fixed point
+    std::atomic<int32_t> lastDuty;  // Last duty written to the PWM peripheral (-1 = none yet); update() writes it
+
+    // One commanded move, handed from the control loop to update()
+    struct Move {
+        MotionProfile profile;
+        uint32_t startUs;           // When the move was published
+        uint32_t rawPulseQ4;        // writeMicroseconds() override, 0 = follow the profile
+    };
+
+    MotionLimits limits;
+    Move move;                      // Control loop's copy of the active move
+    Seqlock<Move> sharedMove;       // Same move, as seen by update()
+    uint32_t arrivalUs;             // Modelled move duration from move.startUs
+    uint32_t settleUs;              // Mechanical settle allowance after arrival
+    float arriveTolerance;          // Measured arrival band (degrees)
+    uint32_t moveId;                // Tags each published move for the feedback sampler
+    ServoFeedback feedback;
+    uint8_t logLane;                // Lane tag for this servo's log events
+    hal::timer::Handle updateTimer; // Created once by init(), then started and stopped
+    bool updating;                  // updateTimer running
+
+    uint32_t angleToDuty(float angle) const;
+    uint32_t pulseToDuty(uint32_t pulseQ4) const;
+    bool writeDuty(uint32_t duty);
+    void publish(const MotionProfile& next, uint32_t modelledUs, uint32_t pulseQ4);
+    void resume();
+    bool readFeedback(ServoFeedback::Reading& reading) const;
+    static void timerCallback(void* arg);
+
 public:
     ServoControl();
     
@@ -24,13 +86,24 @@ public:
 
     void init(int servoPin, int pwmChannel = 7, int freq = 50, int res = 14);
     void write(float angle);
+    void moveTo(float angle);
     void writeMicroseconds(int microseconds);
     void detach();
-    
-    void setPulseWidthRange(int minUs, int maxUs);
-    void setAngleRange(int minDeg, int maxDeg);
-    
-    bool hasReachedTarget();
+    void attachFeedback(int adcPin) { feedback.begin(adcPin); }
+
+    void setMotionLimits(const MotionLimits& newLimits) { limits = newLimits; }
+    void setSettleTime(uint32_t us) { settleUs = us; }
+    void setArriveTolerance(float degrees) { arriveTolerance = degrees; }
+    void setLogLane(uint8_t lane) { logLane = lane; }
+    void update();                  // Called every PWM frame by the update timer
+    bool pause();                   // Stop the update timer once the final duty is out; false if not yet
+
+    float currentAngle() const;     // Commanded position right now, per the profile
+    float measuredAngle() const;    // Feedback position, or currentAngle() without a usable one
+    bool isMoving() const;
+    bool hasReachedTarget() const;  // Measured arrival plus settle time; modelled without feedback
+    bool measuringArrival() const;  // hasReachedTarget() is using feedback right now
+    uint32_t moveTimeUs() const;    // Command to arrival of the current move (before the settle time)
 };
 
-#endif 
\ No newline at end of file
+#endif
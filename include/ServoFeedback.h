@@ -0,0 +1,62 @@
+#ifndef SERVO_FEEDBACK_H
+#define SERVO_FEEDBACK_H
+
+#include <stdint.h>
+#include "hal/Hal.h"
+#include "Seqlock.h"
+
+//* ************************************************************************
+//* ************************** SERVO FEEDBACK ******************************
+//* ************************************************************************
+//! Measured arm position from a feedback servo's position output. A timer
+//! samples the ADC SERVO_FEEDBACK_SAMPLE_HZ times a second, averaging
+//! SERVO_FEEDBACK_OVERSAMPLE reads, and low-pass filters the angle and the
+//! speed. The same callback decides whether the arm has settled on the
+//! current target: within the tolerance band and slower than
+//! SERVO_SETTLED_SPEED. The control loop only reads the published result.
+class ServoFeedback {
+public:
+    struct Reading {
+        float angle;              // Filtered position (degrees)
+        float speed;              // Filtered speed (deg/s)
+        uint32_t move;            // Target the settled flag refers to (see track())
+        uint32_t settledSinceUs;  // Arrival time, while settled
+        bool settled;
+        bool valid;               // False until sampled, or while the signal is out of range
+    };
+
+    ServoFeedback();
+
+    void begin(int adcPin);       // Not calling it (or pin -1) leaves the servo without feedback
+    bool fitted() const { return pin >= 0; }
+
+    // New target from the control loop; `move` tags the readings that refer to it
+    void track(uint32_t move, float targetAngle, float tolerance);
+    void pause();                 // Stop sampling; the last reading stays published
+    void resume();
+
+    Reading read() const { return published.read(); }
+
+private:
+    struct Target {
+        uint32_t move;
+        float angle;
+        float tolerance;
+    };
+
+    int pin;
+    hal::timer::Handle sampleTimer;   // Created once by begin(), then started and stopped
+    bool sampling;                    // sampleTimer running
+    Seqlock<Target> target;       // Control loop -> sampler
+    Seqlock<Reading> published;   // Sampler -> control loop
+
+    // Sampler only
+    Target current;
+    Reading state;
+    uint32_t lastSampleUs;
+
+    void sample();
+    static void timerCallback(void* arg);
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <stdint.h>
+
+//* ************************************************************************
+//* ************************** SPSC QUEUE **********************************
+//* ************************************************************************
+//! Fixed-size lock-free queue for exactly one producer and one consumer
+//! (task-to-task or ISR-to-task). Neither side ever blocks: push() fails
+//! when full and pop() fails when empty. SIZE must be a power of two.
+
+template <typename T, uint32_t SIZE>
+class SpscQueue {
+    static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "SpscQueue SIZE must be a power of two");
+
+private:
+    T slots[SIZE];
+    std::atomic<uint32_t> head;   // Next slot to write, producer only
+    std::atomic<uint32_t> tail;   // Next slot to read, consumer only
+
+public:
+    SpscQueue() : slots(), head(0), tail(0) {}
+
+    bool push(const T& item) {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= SIZE) return false;
+        slots[h & (SIZE - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        item = slots[t & (SIZE - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Look at the oldest item without consuming it (consumer only)
+    bool peek(T& item) const {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        item = slots[t & (SIZE - 1)];
+        return true;
+    }
+
+    bool empty() const {
+        return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+    }
+
+    // Consumer only: drop everything queued so far
+    void clear() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+};
+
+#endif
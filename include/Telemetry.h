@@ -0,0 +1,37 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "TelemetryProtocol.h"
+
+//* ************************************************************************
+//* ***************************** TELEMETRY ********************************
+//* ************************************************************************
+//! Cycle records from the control path, batched into UDP datagrams by the
+//! network task. submit() is a lock-free queue push that drops (and counts)
+//! when full, so the control path never waits on the network. poll() sends
+//! a datagram when a batch fills or has waited FLUSH_MS, never more often
+//! than MIN_INTERVAL_MS; records queue up in between.
+
+namespace Telemetry {
+
+const uint32_t QUEUE_SIZE = 32;         // Records; must be a power of two
+const uint32_t FLUSH_MS = 1000;         // Longest a partial batch waits
+const uint32_t MIN_INTERVAL_MS = 250;   // Rate limit between datagrams
+
+void init(uint32_t bootId, uint8_t laneCount);
+bool submit(const TelemetryRecord& record);   // Control task; never blocks
+void poll(uint32_t nowMs);                    // Network task; batches and sends
+
+uint32_t droppedCount();                      // Records lost (queue full or send failed)
+uint32_t sentDatagrams();
+
+// Per-platform datagram transport (TelemetryUdp.cpp / native/TelemetrySocket.cpp)
+namespace transport {
+bool send(const uint8_t* data, size_t length);
+}
+
+} // namespace Telemetry
+
+#endif
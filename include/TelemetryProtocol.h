@@ -0,0 +1,129 @@
+#ifndef TELEMETRY_PROTOCOL_H
+#define TELEMETRY_PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//* ************************************************************************
+//* ********************** TELEMETRY WIRE FORMAT ***************************
+//* ************************************************************************
+//! One UDP datagram = a 16-byte header followed by up to
+//! TELEMETRY_MAX_RECORDS cycle records of TELEMETRY_RECORD_SIZE bytes.
+//! All fields are little-endian and written field by field, so the format
+//! doesn't depend on struct packing. Shared by the firmware and the host
+//! receiver (tools/telemetry_receiver).
+//!
+//!   header:  magic u32 | version u8 | count u8 | lane count u8 | reserved u8
+//!            boot id u32 | records dropped on the device u32
+//!   record:  sequence u32 | end ms u32 | cycle us u32 | start latency us u32
+//!            trigger u8 | flags u8 | lane u8 | step count u8
+//!            step us u32 x TELEMETRY_MAX_STEPS
+
+const uint32_t TELEMETRY_MAGIC = 0x314C5452;      // "RTL1"
+const uint8_t TELEMETRY_VERSION = 1;
+const uint16_t TELEMETRY_PORT = 4211;
+const int TELEMETRY_MAX_STEPS = 16;
+const int TELEMETRY_MAX_RECORDS = 16;
+const size_t TELEMETRY_HEADER_SIZE = 16;
+const size_t TELEMETRY_RECORD_SIZE = 20 + 4 * TELEMETRY_MAX_STEPS;
+const size_t TELEMETRY_DATAGRAM_MAX = TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_RECORDS * TELEMETRY_RECORD_SIZE;
+
+enum TelemetryTrigger : uint8_t { TRIGGER_NONE, TRIGGER_SENSOR, TRIGGER_MANUAL, TRIGGER_RETRY };
+
+// Record flags
+const uint8_t TELEMETRY_FLAG_FAULT = 0x01;         // The cycle ended in or passed through a fault
+const uint8_t TELEMETRY_FLAG_STEP_TIMEOUT = 0x02;  // At least one step overran its timeout
+
+struct TelemetryHeader {
+    uint8_t recordCount;
+    uint8_t laneCount;
+    uint32_t bootId;             // Changes every boot, so the receiver can reset its sequence tracking
+    uint32_t droppedRecords;     // Records the device could not queue, since boot
+};
+
+struct TelemetryRecord {
+    uint32_t sequence;           // Cycle number since boot
+    uint32_t endMs;              // Device uptime at the end of the cycle
+    uint32_t cycleUs;            // Leaving IDLE to back in IDLE
+    uint32_t startLatencyUs;     // Start edge to cylinder, past the start delay (0 = not measured)
+    uint8_t trigger;             // TelemetryTrigger
+    uint8_t flags;
+    uint8_t lane;
+    uint8_t stepCount;           // Valid entries in stepUs
+    uint32_t stepUs[TELEMETRY_MAX_STEPS];   // Time spent in each step this cycle
+};
+
+namespace TelemetryWire {
+
+inline void putU32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+inline uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Returns the datagram length, or 0 if it doesn't fit in `capacity`
+inline size_t encode(uint8_t* out, size_t capacity, const TelemetryHeader& header,
+                     const TelemetryRecord* records) {
+    const size_t length = TELEMETRY_HEADER_SIZE + header.recordCount * TELEMETRY_RECORD_SIZE;
+    if (header.recordCount > TELEMETRY_MAX_RECORDS || length > capacity) return 0;
+
+    putU32(out, TELEMETRY_MAGIC);
+    out[4] = TELEMETRY_VERSION;
+    out[5] = header.recordCount;
+    out[6] = header.laneCount;
+    out[7] = 0;
+    putU32(out + 8, header.bootId);
+    putU32(out + 12, header.droppedRecords);
+
+    uint8_t* p = out + TELEMETRY_HEADER_SIZE;
+    for (int i = 0; i < header.recordCount; i++, p += TELEMETRY_RECORD_SIZE) {
+        const TelemetryRecord& r = records[i];
+        putU32(p, r.sequence);
+        putU32(p + 4, r.endMs);
+        putU32(p + 8, r.cycleUs);
+        putU32(p + 12, r.startLatencyUs);
+        p[16] = r.trigger;
+        p[17] = r.flags;
+        p[18] = r.lane;
+        p[19] = r.stepCount;
+        for (int s = 0; s < TELEMETRY_MAX_STEPS; s++) putU32(p + 20 + 4 * s, r.stepUs[s]);
+    }
+    return length;
+}
+
+// False if the datagram is malformed, from another version or doesn't fit
+// in `maxRecords`
+inline bool decode(const uint8_t* in, size_t length, TelemetryHeader& header,
+                   TelemetryRecord* records, int maxRecords) {
+    if (length < TELEMETRY_HEADER_SIZE || getU32(in) != TELEMETRY_MAGIC || in[4] != TELEMETRY_VERSION) return false;
+    header.recordCount = in[5];
+    header.laneCount = in[6];
+    header.bootId = getU32(in + 8);
+    header.droppedRecords = getU32(in + 12);
+    if (header.recordCount > maxRecords ||
+        length != TELEMETRY_HEADER_SIZE + header.recordCount * TELEMETRY_RECORD_SIZE) return false;
+
+    const uint8_t* p = in + TELEMETRY_HEADER_SIZE;
+    for (int i = 0; i < header.recordCount; i++, p += TELEMETRY_RECORD_SIZE) {
+        TelemetryRecord& r = records[i];
+        r.sequence = getU32(p);
+        r.endMs = getU32(p + 4);
+        r.cycleUs = getU32(p + 8);
+        r.startLatencyUs = getU32(p + 12);
+        r.trigger = p[16];
+        r.flags = p[17];
+        r.lane = p[18];
+        r.stepCount = p[19] < TELEMETRY_MAX_STEPS ? p[19] : TELEMETRY_MAX_STEPS;
+        for (int s = 0; s < TELEMETRY_MAX_STEPS; s++) r.stepUs[s] = getU32(p + 20 + 4 * s);
+    }
+    return true;
+}
+
+} // namespace TelemetryWire
+
+#endif
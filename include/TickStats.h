@@ -0,0 +1,42 @@
+#ifndef TICK_STATS_H
+#define TICK_STATS_H
+
+#include <stdint.h>
+
+//* ************************************************************************
+//* ************************ TICK JITTER STATS *****************************
+//* ************************************************************************
+//! Accumulates how far each control tick started from its nominal period,
+//! and how long the tick body ran. Every output edge the state machine
+//! produces lands on a tick, so maxJitterUs bounds the edge timing error.
+
+struct TickStats {
+    uint32_t ticks;          // Ticks recorded in this window
+    uint32_t periodUs;       // Nominal tick period
+    uint32_t maxJitterUs;    // Largest |interval - period|
+    uint32_t sumJitterUs;    // Sum of |interval - period|, for the mean
+    uint32_t maxBodyUs;      // Longest tick body
+    uint32_t overruns;       // Ticks whose body ran longer than the period
+
+    void reset(uint32_t nominalPeriodUs) {
+        ticks = 0;
+        periodUs = nominalPeriodUs;
+        maxJitterUs = 0;
+        sumJitterUs = 0;
+        maxBodyUs = 0;
+        overruns = 0;
+    }
+
+    void record(uint32_t intervalUs, uint32_t bodyUs) {
+        const uint32_t jitter = intervalUs > periodUs ? intervalUs - periodUs : periodUs - intervalUs;
+        ticks++;
+        sumJitterUs += jitter;
+        if (jitter > maxJitterUs) maxJitterUs = jitter;
+        if (bodyUs > maxBodyUs) maxBodyUs = bodyUs;
+        if (bodyUs > periodUs) overruns++;
+    }
+
+    uint32_t meanJitterUs() const { return ticks ? sumJitterUs / ticks : 0; }
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+#include <stdint.h>
+
+//* ************************************************************************
+//* ************************** CRASH TRACE RING ****************************
+//* ************************************************************************
+//! The last TRACE_ENTRIES step transitions of every lane, in memory that
+//! survives a reset (RTC slow memory on target). A brownout, watchdog or
+//! panic reset leaves them in place; init() on the next boot takes a copy
+//! for the "trace" command and starts this boot's ring. Only a power-on
+//! loses them.
+//!
+//! record() is a handful of stores with no formatting and no locking, so
+//! it stays on in production. The control task is the only writer.
+
+const uint32_t TRACE_ENTRIES = 64;   // Must be a power of two
+
+// Output levels right after the step's entry action ran
+enum TraceOutput : uint8_t {
+    TRACE_OUT_CYLINDER = 1 << 0,      // Feed cylinder driven
+    TRACE_OUT_SERVO_MOVING = 1 << 1,  // Flip servo still following its profile
+};
+
+struct TraceEntry {
+    uint32_t timeMs;        // Since boot
+    uint8_t lane;
+    uint8_t step;           // StepId entered
+    uint8_t outputs;        // TraceOutput bits
+    uint8_t fault;          // FaultCause being handled, 0 = none
+    int16_t servoDeciDeg;   // Commanded servo angle (0.1 deg)
+    uint16_t cycle;         // Low bits of the telemetry sequence of the cycle in progress (IDLE: the next)
+};
+
+// A ring's entries oldest first, and the boot that wrote them
+struct TraceSnapshot {
+    bool valid;             // False after a power-on: nothing survived
+    uint32_t boot;          // Boots since the last power-on, counting from 1
+    uint8_t resetReason;    // How that boot ended (see resetReasonName); 0 for current()
+    uint32_t total;         // Transitions recorded; the ring keeps the last TRACE_ENTRIES
+    uint32_t count;
+    TraceEntry entries[TRACE_ENTRIES];
+};
+
+namespace TraceRing {
+
+// Keep what the previous boot left and start a fresh ring. Call once at
+// boot, before the state machine starts, with the platform reset reason.
+void init(uint8_t resetReason);
+
+void record(const TraceEntry& entry);     // Control task only
+
+const TraceSnapshot& lastBoot();          // As init() found it
+void current(TraceSnapshot& out);         // This boot so far (the newest entry may be mid-write)
+
+const char* resetReasonName(uint8_t reason);
+
+} // namespace TraceRing
+
+#endif
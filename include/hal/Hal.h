@@ -0,0 +1,48 @@
+#ifndef HAL_H
+#define HAL_H
+
+//* ************************************************************************
+//* ******************** HARDWARE ABSTRACTION LAYER ************************
+//* ************************************************************************
+//! Thin, zero-overhead layer between the machine logic and the hardware.
+//! Pins are bound at compile time as template parameters so every access
+//! inlines down to a single register store on the ESP32-S3. Building with
+//! -DROUTER_NATIVE swaps in a simulated clock and simulated I/O so the same
+//! state machine runs on Linux (see [env:native] in platformio.ini).
+
+#include <stdint.h>
+
+namespace hal {
+enum class Pull : uint8_t { None, Up, Down };
+}
+
+#if defined(ROUTER_NATIVE)
+#include "hal/HalNative.h"
+#else
+#include "hal/HalEsp32.h"
+#endif
+
+namespace hal {
+
+//* ************************************************************************
+//* ************************* DIGITAL OUTPUT ******************************
+//* ************************************************************************
+template <int PIN>
+struct OutputPin {
+    static void begin() { gpio::configOutput(PIN); }
+    static inline void write(uint8_t level) { gpio::write<PIN>(level != 0); }
+    static inline bool read() { return gpio::readOutput<PIN>(); }
+};
+
+//* ************************************************************************
+//* ************************* DIGITAL INPUT *******************************
+//* ************************************************************************
+template <int PIN>
+struct InputPin {
+    static void begin(Pull pull) { gpio::configInput(PIN, pull); }
+    static inline bool read() { return gpio::read<PIN>(); }
+};
+
+} // namespace hal
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef HAL_ESP32_H
+#define HAL_ESP32_H
+
+//* ************************************************************************
+//* ********************** HAL BACKEND: ESP32-S3 ***************************
+//* ************************************************************************
+//! Direct GPIO register access for the target. Only include via hal/Hal.h.
+
+#include <Arduino.h>
+#include "soc/gpio_reg.h"
+#include "driver/gpio.h"
+#include "hal/gpio_ll.h"
+#include "esp_timer.h"
+
+// Interrupt handlers and everything they call must live in IRAM
+#define HAL_ISR_ATTR IRAM_ATTR
+
+// Not cleared at boot: keeps its contents through any reset but power-on
+#define HAL_NOINIT_ATTR RTC_NOINIT_ATTR
+
+namespace hal {
+
+//* ************************************************************************
+//* ****************************** CLOCK **********************************
+//* ************************************************************************
+struct Clock {
+    static inline uint32_t millis() { return ::millis(); }
+    static inline uint32_t micros() { return ::micros(); }
+};
+
+//* ************************************************************************
+//* ****************************** GPIO ***********************************
+//* ************************************************************************
+//! GPIO 0-31 live in the first output/input bank, GPIO 32-48 in the second.
+//! The bank and bit mask are resolved at compile time from the pin number.
+namespace gpio {
+
+template <int PIN>
+struct Bank {
+    static_assert(PIN >= 0 && PIN <= 48, "ESP32-S3 GPIO number out of range");
+    static constexpr uint32_t MASK = 1UL << (PIN & 31);
+    static constexpr uint32_t SET_REG = PIN < 32 ? GPIO_OUT_W1TS_REG : GPIO_OUT1_W1TS_REG;
+    static constexpr uint32_t CLEAR_REG = PIN < 32 ? GPIO_OUT_W1TC_REG : GPIO_OUT1_W1TC_REG;
+    static constexpr uint32_t OUT_REG = PIN < 32 ? GPIO_OUT_REG : GPIO_OUT1_REG;
+    static constexpr uint32_t IN_REG = PIN < 32 ? GPIO_IN_REG : GPIO_IN1_REG;
+};
+
+inline void configOutput(int pin) { pinMode(pin, OUTPUT); }
+
+inline void configInput(int pin, Pull pull) {
+    pinMode(pin, pull == Pull::Up ? INPUT_PULLUP : pull == Pull::Down ? INPUT_PULLDOWN : INPUT);
+}
+
+template <int PIN>
+inline void write(bool high) {
+    REG_WRITE(high ? Bank<PIN>::SET_REG : Bank<PIN>::CLEAR_REG, Bank<PIN>::MASK);
+}
+
+template <int PIN>
+inline bool read() {
+    return (REG_READ(Bank<PIN>::IN_REG) & Bank<PIN>::MASK) != 0;
+}
+
+template <int PIN>
+inline bool readOutput() {
+    return (REG_READ(Bank<PIN>::OUT_REG) & Bank<PIN>::MASK) != 0;
+}
+
+// Interrupt on both edges; the callback runs in ISR context
+typedef void (*EdgeCallback)(void* arg);
+
+inline void attachEdgeInterrupt(int pin, EdgeCallback callback, void* arg) {
+    attachInterruptArg(pin, callback, arg, CHANGE);
+}
+
+inline void detachEdgeInterrupt(int pin) { detachInterrupt(pin); }
+
+// Light-sleep wake-up on a pin level. Edges cannot wake the chip, so the
+// pin's interrupt is level-triggered while armed: the first ISR it raises
+// must call disarmWake(), which is plain register access and IRAM-safe.
+inline void armWake(int pin, bool level) {
+    gpio_wakeup_enable((gpio_num_t)pin, level ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+}
+
+HAL_ISR_ATTR inline void disarmWake(int pin) {
+    gpio_ll_wakeup_disable(&GPIO, (gpio_num_t)pin);
+    gpio_ll_set_intr_type(&GPIO, (gpio_num_t)pin, GPIO_INTR_ANYEDGE);
+}
+
+} // namespace gpio
+
+//* ************************************************************************
+//* ****************************** PWM ************************************
+//* ************************************************************************
+//! LEDC channels are a runtime resource (ServoControl::init takes one), so
+//! PWM stays a plain function interface over the Arduino LEDC driver.
+namespace pwm {
+
+inline void setup(int channel, int frequency, int resolution) { ledcSetup(channel, frequency, resolution); }
+inline void attach(int pin, int channel) { ledcAttachPin(pin, channel); }
+inline void detach(int pin) { ledcDetachPin(pin); }
+inline void write(int channel, uint32_t duty) { ledcWrite(channel, duty); }
+
+} // namespace pwm
+
+//* ************************************************************************
+//* ****************************** ADC ************************************
+//* ************************************************************************
+//! Calibrated millivolt reads. ADC1 pins only: ADC2 is taken by WiFi.
+namespace adc {
+
+inline void setup(int pin) { analogSetPinAttenuation(pin, ADC_11db); }   // Full 0-3.1 V range
+inline uint32_t readMilliVolts(int pin) { return analogReadMilliVolts(pin); }
+
+} // namespace adc
+
+//* ************************************************************************
+//* ************************* PERIODIC TIMER ******************************
+//* ************************************************************************
+//! Hardware-timer backed periodic callback (esp_timer). Callbacks run in the
+//! high-priority esp_timer task, so they must be short and must not block.
+//! A timer is created once, stopped, and then started and stopped on the
+//! same handle as often as needed; the caller tracks whether it runs.
+namespace timer {
+
+typedef void (*Callback)(void* arg);
+typedef esp_timer_handle_t Handle;
+
+inline Handle create(Callback callback, void* arg, const char* name) {
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = callback;
+    timerArgs.arg = arg;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = name;
+
+    esp_timer_handle_t handle = nullptr;
+    if (esp_timer_create(&timerArgs, &handle) != ESP_OK) return nullptr;
+    return handle;
+}
+
+inline void start(Handle handle, uint32_t periodUs) {
+    if (handle) esp_timer_start_periodic(handle, periodUs);
+}
+
+inline void stop(Handle handle) {
+    if (handle) esp_timer_stop(handle);
+}
+
+} // namespace timer
+
+} // namespace hal
+
+#endif
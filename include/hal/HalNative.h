@@ -0,0 +1,160 @@
+#ifndef HAL_NATIVE_H
+#define HAL_NATIVE_H
+
+//* ************************************************************************
+//* ********************** HAL BACKEND: NATIVE (LINUX) *********************
+//* ************************************************************************
+//! Simulated clock and I/O for the [env:native] build. Time only moves when
+//! the host program calls hal::sim::advanceMicros(), so runs are repeatable.
+//! Only include via hal/Hal.h.
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef HIGH
+#define HIGH 0x1
+#endif
+#ifndef LOW
+#define LOW 0x0
+#endif
+
+#define HAL_ISR_ATTR
+#define HAL_NOINIT_ATTR
+
+namespace hal {
+
+//* ************************************************************************
+//* ************************ SIMULATION STATE *****************************
+//* ************************************************************************
+namespace sim {
+
+const int NUM_PINS = 49;
+const int NUM_PWM_CHANNELS = 8;
+
+extern uint64_t nowMicros;
+extern uint8_t pinLevels[NUM_PINS];
+extern uint32_t pwmDuty[NUM_PWM_CHANNELS];
+extern uint32_t adcMilliVolts[NUM_PINS];
+
+void reset();
+void advanceMicros(uint32_t us);
+void setInput(int pin, bool level);   // Fires the pin's edge interrupt on a change
+bool getOutput(int pin);
+uint32_t getPwmDuty(int channel);
+void setAdc(int pin, uint32_t milliVolts);
+
+} // namespace sim
+
+//* ************************************************************************
+//* ****************************** CLOCK **********************************
+//* ************************************************************************
+struct Clock {
+    static inline uint32_t millis() { return (uint32_t)(sim::nowMicros / 1000); }
+    static inline uint32_t micros() { return (uint32_t)sim::nowMicros; }
+};
+
+//* ************************************************************************
+//* ****************************** GPIO ***********************************
+//* ************************************************************************
+namespace gpio {
+
+inline void configOutput(int) {}
+inline void configInput(int, Pull) {}
+
+template <int PIN>
+inline void write(bool high) {
+    static_assert(PIN >= 0 && PIN < sim::NUM_PINS, "GPIO number out of range");
+    sim::pinLevels[PIN] = high;
+}
+
+template <int PIN>
+inline bool read() {
+    static_assert(PIN >= 0 && PIN < sim::NUM_PINS, "GPIO number out of range");
+    return sim::pinLevels[PIN] != 0;
+}
+
+template <int PIN>
+inline bool readOutput() { return read<PIN>(); }
+
+typedef void (*EdgeCallback)(void* arg);
+
+void attachEdgeInterrupt(int pin, EdgeCallback callback, void* arg);
+void detachEdgeInterrupt(int pin);
+
+} // namespace gpio
+
+//* ************************************************************************
+//* ****************************** PWM ************************************
+//* ************************************************************************
+namespace pwm {
+
+inline void setup(int, int, int) {}
+inline void attach(int, int) {}
+inline void detach(int) {}
+inline void write(int channel, uint32_t duty) {
+    if (channel >= 0 && channel < sim::NUM_PWM_CHANNELS) sim::pwmDuty[channel] = duty;
+}
+
+} // namespace pwm
+
+//* ************************************************************************
+//* ****************************** ADC ************************************
+//* ************************************************************************
+namespace adc {
+
+inline void setup(int) {}
+inline uint32_t readMilliVolts(int pin) {
+    return pin >= 0 && pin < sim::NUM_PINS ? sim::adcMilliVolts[pin] : 0;
+}
+
+} // namespace adc
+
+//* ************************************************************************
+//* ************************* PERIODIC TIMER ******************************
+//* ************************************************************************
+//! Simulated periodic timers fire from inside sim::advanceMicros(), at their
+//! exact due times, in due-time order. Same create-once, start/stop model
+//! as the target; sim::reset() discards every timer.
+namespace timer {
+
+typedef void (*Callback)(void* arg);
+typedef int Handle;  // 0 = no timer
+
+Handle create(Callback callback, void* arg, const char* name);
+void start(Handle handle, uint32_t periodUs);
+void stop(Handle handle);
+
+} // namespace timer
+
+} // namespace hal
+
+//* ************************************************************************
+//* *************************** SERIAL SHIM *******************************
+//* ************************************************************************
+//! Minimal stand-in for the Arduino Serial object; prints to stdout.
+class NativeSerial {
+private:
+    bool quiet = false;
+
+public:
+    void begin(unsigned long) {}
+    void setQuiet(bool q) { quiet = q; }   // Drop all output (benchmark runs)
+    int available() { return 0; }    // No console input in the simulation
+    int read() { return -1; }
+    void print(const char* s) { if (!quiet) fputs(s, stdout); }
+    void print(char c) { if (!quiet) fputc(c, stdout); }
+    void print(int v) { if (!quiet) ::printf("%d", v); }
+    void print(unsigned int v) { if (!quiet) ::printf("%u", v); }
+    void print(long v) { if (!quiet) ::printf("%ld", v); }
+    void print(unsigned long v) { if (!quiet) ::printf("%lu", v); }
+    void print(double v) { if (!quiet) ::printf("%.2f", v); }
+    template <typename T>
+    void println(T v) { print(v); println(); }
+    void println() { if (!quiet) fputc('\n', stdout); }
+    template <typename... Args>
+    void printf(const char* fmt, Args... args) { if (!quiet) ::printf(fmt, args...); }
+};
+
+extern NativeSerial Serial;
+
+#endif
@@ -0,0 +1,58 @@
+#include "CommandUdp.h"
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "SerialCommands.h"
+
+static WiFiUDP udp;
+static bool listening = false;
+
+// Collects a reply into datagrams, flushing whenever one fills up
+struct UdpReply : CommandOutput {
+    static const size_t PACKET_MAX = 1400;   // Stay under a typical MTU
+    char packet[PACKET_MAX];
+    size_t length = 0;
+    IPAddress remoteIp;
+    uint16_t remotePort = 0;
+
+    void write(const char* text) override {
+        for (; *text; text++) {
+            if (length == PACKET_MAX) flush();
+            packet[length++] = *text;
+        }
+    }
+
+    void flush() {
+        if (length == 0) return;
+        udp.beginPacket(remoteIp, remotePort);
+        udp.write((const uint8_t*)packet, length);
+        udp.endPacket();
+        length = 0;
+    }
+};
+
+namespace CommandUdp {
+
+void begin() {
+    listening = udp.begin(PORT) == 1;
+    if (listening) Serial.printf("Command UDP listening on port %u\n", (unsigned)PORT);
+}
+
+void poll() {
+    if (!listening) return;
+
+    char line[96];
+    while (udp.parsePacket() > 0) {
+        int length = udp.read((uint8_t*)line, sizeof(line) - 1);
+        if (length < 0) length = 0;
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) length--;
+        line[length] = '\0';
+
+        UdpReply reply;
+        reply.remoteIp = udp.remoteIP();
+        reply.remotePort = udp.remotePort();
+        SerialCommands::execute(line, reply);
+        reply.flush();
+    }
+}
+
+} // namespace CommandUdp
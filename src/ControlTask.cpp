@@ -0,0 +1,267 @@
+//* ************************************************************************
+//* ************************** CONTROL TASK ********************************
+//* ************************************************************************
+//! Fixed-rate state machine tick on its own core. WiFi, OTA, the log drain
+//! and the esp_timer task all live on core 0; this task owns core 1.
+//! Start-input edges notify the task so it reacts within microseconds
+//! instead of waiting up to a full tick.
+//!
+//! Every tick runs each lane in turn. Steps never block, so a lane only
+//! ever waits for the other lanes' few-microsecond tick bodies, and its
+//! edges are timestamped by the ISR regardless.
+//!
+//! Once every lane has been at rest for IDLE_SETTLE_MS the task stops
+//! ticking and blocks on its notification until a start input, a command
+//! (wakeControl) or the lanes' next timed event. With IDLE_LIGHT_SLEEP the
+//! chip may also light-sleep meanwhile; the start inputs are armed as GPIO
+//! wake sources for it.
+
+#include <Arduino.h>
+#include <atomic>
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "ControlTask.h"
+#include "Seqlock.h"
+#include "Logger.h"
+#include "StateMachine/StateMachine.h"
+#include "EdgeInput.h"
+#include "LoopProfiler.h"
+
+const UBaseType_t CONTROL_TASK_PRIORITY = configMAX_PRIORITIES - 2;
+const BaseType_t CONTROL_TASK_CORE = 1;
+const uint32_t CONTROL_TASK_STACK = 4096;
+const uint32_t JITTER_WINDOW_TICKS = CONTROL_TICK_HZ * 10;  // Report every 10 s
+const int WAKE_PIN_COUNT = LANE_COUNT * 2;                    // Start sensor and manual start per lane
+
+static_assert(IDLE_SETTLE_MS > START_SENSOR_DEBOUNCE_MS && IDLE_SETTLE_MS > MANUAL_START_DEBOUNCE_MS,
+              "Ticks must not stop before an input's debounce lockout has passed");
+
+static Seqlock<TickStats> publishedWindow;
+static Seqlock<IdleStats> publishedIdle;
+static TaskHandle_t controlHandle = nullptr;
+
+// First input edge of an idle spell, for the wake latency
+static std::atomic<bool> inputWoke(false);
+static std::atomic<uint32_t> inputWokeUs(0);
+
+// Light sleep: held except while the task sleeps idle
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t awakeLock = nullptr;
+#endif
+static bool lightSleep = false;
+static int wakePins[WAKE_PIN_COUNT];
+static bool wakeArmed = false;
+static portMUX_TYPE wakeMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Level-triggered while armed: put the edge interrupts back on the first
+// one, before it can fire again
+static void IRAM_ATTR disarmWakeInputs() {
+    portENTER_CRITICAL_ISR(&wakeMux);
+    if (wakeArmed) {
+        for (int pin : wakePins) hal::gpio::disarmWake(pin);
+        wakeArmed = false;
+    }
+    portEXIT_CRITICAL_ISR(&wakeMux);
+}
+
+// Edge ISR hook: run the state machine now instead of at the next tick
+static void IRAM_ATTR wakeControlTask() {
+    disarmWakeInputs();
+    if (!inputWoke.exchange(true, std::memory_order_relaxed)) inputWokeUs.store(micros(), std::memory_order_relaxed);
+
+    BaseType_t higherPriorityWoken = pdFALSE;
+    if (controlHandle) vTaskNotifyGiveFromISR(controlHandle, &higherPriorityWoken);
+    portYIELD_FROM_ISR(higherPriorityWoken);
+}
+
+// Command hook (wakeControl): task context only
+static void wakeFromTask() {
+    if (controlHandle) xTaskNotifyGive(controlHandle);
+}
+
+static void runTick() {
+    const uint32_t startUs = micros();
+    for (Lane& lane : lanes) {
+        PROFILE_SECTION(SEC_INPUTS, updateInputs(lane));
+        PROFILE_SECTION(SEC_STATE_MACHINE, handleStateMachine(lane));
+    }
+    LoopProfiler::recordIteration(LoopProfiler::LOOP_CONTROL, micros() - startUs);
+}
+
+//* ************************************************************************
+//* ****************************** IDLE SLEEP ******************************
+//* ************************************************************************
+static void initLightSleep() {
+    int n = 0;
+    for (const LanePins& pins : LANE_PINS) {
+        wakePins[n++] = pins.startSensor;
+        wakePins[n++] = pins.manualStart;
+    }
+    if (!IDLE_LIGHT_SLEEP) return;
+
+#if CONFIG_PM_ENABLE
+    // Clocks stay at full speed: only idle time is given up, never tick time
+    esp_pm_config_esp32s3_t pm = {};
+    pm.max_freq_mhz = getCpuFrequencyMhz();
+    pm.min_freq_mhz = pm.max_freq_mhz;
+    pm.light_sleep_enable = true;
+
+    esp_err_t err = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "control", &awakeLock);
+    if (err == ESP_OK) err = esp_pm_lock_acquire(awakeLock);
+    if (err == ESP_OK) err = esp_sleep_enable_gpio_wakeup();
+    if (err == ESP_OK) err = esp_pm_configure(&pm);   // Not supported without tickless idle
+    lightSleep = err == ESP_OK;
+    if (!lightSleep) LOG_WARN(EV_LIGHT_SLEEP_OFF, LOG_NO_LANE, 0, 0, err, 0);
+#else
+    LOG_WARN(EV_LIGHT_SLEEP_OFF, LOG_NO_LANE, 0, 0, ESP_ERR_NOT_SUPPORTED, 0);
+#endif
+}
+
+// Any change on a start input wakes the chip
+static void allowLightSleep() {
+    if (!lightSleep) return;
+    portENTER_CRITICAL(&wakeMux);
+    for (int pin : wakePins) hal::gpio::armWake(pin, digitalRead(pin) == LOW);
+    wakeArmed = true;
+    portEXIT_CRITICAL(&wakeMux);
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_release(awakeLock);
+#endif
+}
+
+static void preventLightSleep() {
+    if (!lightSleep) return;
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_acquire(awakeLock);
+#endif
+    disarmWakeInputs();
+}
+
+// Shortest time any lane can go unticked; 0 if one is busy
+static uint32_t lanesRestMs() {
+    uint32_t restMs = LANE_REST_FOREVER;
+    for (const Lane& lane : lanes) {
+        const uint32_t laneMs = laneRestMs(lane);
+        if (laneMs < restMs) restMs = laneMs;
+    }
+    return restMs;
+}
+
+// Block until an input edge, a command or the lanes' next timed event.
+// Returns once the lanes need ticking again, having already ticked them.
+static void sleepWhileIdle(uint32_t restMs, IdleStats& stats) {
+    for (Lane& lane : lanes) {
+        if (!lane.flipServo.pause()) return;   // Last frame not out yet; next tick
+    }
+
+    LOG_DEBUG(EV_IDLE_SLEEP, LOG_NO_LANE, 0, 0, 0, 0);
+    LoopProfiler::publish(LoopProfiler::LOOP_CONTROL);   // The last partial second, before going quiet
+    const uint32_t sleepStartMs = millis();
+    inputWoke.store(false, std::memory_order_relaxed);
+    allowLightSleep();
+
+    bool notified = false;
+    while (!notified && restMs > 0) {
+        const uint32_t waitMs = restMs < IDLE_MAX_SLEEP_MS ? restMs : IDLE_MAX_SLEEP_MS;
+        notified = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs)) > 0;
+        if (!notified) {
+            runTick();   // A timed event came due, or the periodic safety check
+            restMs = lanesRestMs();
+        }
+    }
+
+    const uint32_t runningUs = micros();
+    preventLightSleep();
+    if (notified) runTick();
+
+    // Only an input edge has a wake latency; commands and timeouts don't
+    const bool byInput = inputWoke.load(std::memory_order_relaxed);
+    const uint32_t wakeUs = byInput ? runningUs - inputWokeUs.load(std::memory_order_relaxed) : 0;
+    const uint32_t sleptMs = millis() - sleepStartMs;
+
+    stats.sleeps++;
+    stats.sleptMs += sleptMs;
+    if (byInput) {
+        stats.inputWakes++;
+        stats.lastWakeUs = wakeUs;
+        if (wakeUs > stats.maxWakeUs) stats.maxWakeUs = wakeUs;
+    }
+    publishedIdle.write(stats);
+
+    LOG_INFO(EV_IDLE_WAKE, LOG_NO_LANE, 0, 0, sleptMs, wakeUs);
+    if (wakeUs > IDLE_WAKE_WARN_US) LOG_WARN(EV_IDLE_WAKE_SLOW, LOG_NO_LANE, 0, 0, wakeUs, IDLE_WAKE_WARN_US);
+}
+
+static void controlTask(void*) {
+    const TickType_t period = pdMS_TO_TICKS(1000 / CONTROL_TICK_HZ);
+    const uint32_t periodUs = 1000000UL / CONTROL_TICK_HZ;
+
+    TickStats window;
+    window.reset(periodUs);
+    IdleStats idle = {};
+
+    TickType_t lastWake = xTaskGetTickCount();
+    uint32_t lastStartUs = micros();
+    uint32_t busyMs = millis();     // Last time a lane had something to do
+    bool resync = false;            // First tick after an idle sleep: no interval to record
+
+    for (;;) {
+        // Sleep until the next periodic tick, unless an input edge wakes us first
+        const TickType_t elapsed = xTaskGetTickCount() - lastWake;
+        const TickType_t wait = elapsed < period ? period - elapsed : 0;
+        if (wait > 0 && ulTaskNotifyTake(pdTRUE, wait) > 0) {
+            runTick();   // Out-of-band pass for the edge; not a periodic tick
+            busyMs = millis();
+            continue;
+        }
+        lastWake += period;
+
+        const uint32_t startUs = micros();
+        runTick();
+        if (!resync) window.record(startUs - lastStartUs, micros() - startUs);
+        lastStartUs = startUs;
+        resync = false;
+
+        const uint32_t restMs = IDLE_SLEEP_ENABLED ? lanesRestMs() : 0;
+        if (restMs == 0) {
+            busyMs = millis();
+        } else if (millis() - busyMs >= IDLE_SETTLE_MS) {
+            sleepWhileIdle(restMs, idle);
+            lastWake = xTaskGetTickCount();
+            busyMs = millis();
+            resync = true;
+        }
+
+        if (window.ticks >= JITTER_WINDOW_TICKS) {
+            publishedWindow.write(window);
+            LOG_INFO(EV_TICK_JITTER, LOG_NO_LANE, 0, 0, window.maxJitterUs, window.meanJitterUs());
+            if (window.overruns) LOG_WARN(EV_TICK_OVERRUN, LOG_NO_LANE, 0, 0, window.overruns, window.maxBodyUs);
+            window.reset(periodUs);
+        }
+    }
+}
+
+namespace ControlTask {
+
+void start() {
+    TickStats empty;
+    empty.reset(1000000UL / CONTROL_TICK_HZ);
+    publishedWindow.write(empty);
+    publishedIdle.write(IdleStats());
+    initLightSleep();
+
+    xTaskCreatePinnedToCore(controlTask, "control", CONTROL_TASK_STACK, nullptr,
+                            CONTROL_TASK_PRIORITY, &controlHandle, CONTROL_TASK_CORE);
+    edgeWakeHook = wakeControlTask;
+    controlWakeHook = wakeFromTask;
+}
+
+TickStats lastWindow() {
+    return publishedWindow.read();
+}
+
+IdleStats idleStats() {
+    return publishedIdle.read();
+}
+
+} // namespace ControlTask
@@ -0,0 +1,161 @@
+#include "DeltaOta.h"
+#include <WiFi.h>
+#include <new>
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "DeltaPatch.h"
+#include "StateMachine/StateMachine.h"
+
+const uint32_t SESSION_IDLE_TIMEOUT_MS = 10000;   // Abort if the sender goes quiet
+const uint32_t STOP_TIMEOUT_MS = 60000;           // Abort if the machine doesn't come to rest
+const size_t CHUNK_SIZE = 1024;
+
+// Base image: the partition we are running from
+class RunningPartition : public PatchSource {
+public:
+    const esp_partition_t* partition = nullptr;
+
+    bool read(uint32_t offset, uint8_t* data, size_t length) override {
+        return partition && esp_partition_read(partition, offset, data, length) == ESP_OK;
+    }
+};
+
+// Output: the next OTA slot, erased by esp_ota_begin() for the image size
+class NextPartition : public PatchSink {
+public:
+    const esp_partition_t* partition = nullptr;
+    esp_ota_handle_t handle = 0;
+
+    bool begin(uint32_t imageSize) override {
+        partition = esp_ota_get_next_update_partition(nullptr);
+        if (!partition || imageSize > partition->size) return false;
+        if (esp_ota_begin(partition, imageSize, &handle) != ESP_OK) {
+            handle = 0;
+            return false;
+        }
+        return true;
+    }
+
+    bool write(const uint8_t* data, size_t length) override {
+        return handle && esp_ota_write(handle, data, length) == ESP_OK;
+    }
+
+    void abort() {
+        if (handle) esp_ota_abort(handle);
+        handle = 0;
+    }
+};
+
+static WiFiServer server(DeltaOta::PORT);
+static WiFiClient client;
+static bool listening = false;
+static bool restartPending = false;
+static bool machineStopped = false;   // Lanes at rest for this session; flash may be written
+static uint32_t lastDataMs = 0;
+static uint32_t holdStartMs = 0;
+
+static RunningPartition source;
+static NextPartition sink;
+static PatchApplier* applier = nullptr;
+alignas(PatchApplier) static uint8_t applierStorage[sizeof(PatchApplier)];
+static uint8_t chunk[CHUNK_SIZE];
+
+static void endSession(const char* reply) {
+    client.print(reply);
+    client.stop();
+    applier = nullptr;
+}
+
+static void failSession(const char* reason) {
+    Serial.printf("Delta OTA failed: %s\n", reason);
+    sink.abort();
+    requestHold(HOLD_DELTA_OTA, false);
+
+    char reply[64];
+    snprintf(reply, sizeof(reply), "ERR %s\n", reason);
+    endSession(reply);
+}
+
+static void finishSession() {
+    if (esp_ota_end(sink.handle) != ESP_OK) {
+        sink.handle = 0;
+        failSession("image rejected by bootloader check");
+        return;
+    }
+    sink.handle = 0;
+    if (esp_ota_set_boot_partition(sink.partition) != ESP_OK) {
+        failSession("could not switch boot partition");
+        return;
+    }
+    Serial.printf("Delta OTA complete: %lu byte image written to %s, restarting when idle\n",
+                  (unsigned long)applier->bytesWritten(), sink.partition->label);
+    endSession("OK\n");
+    restartPending = true;   // Hold stays on so no new cycle starts
+}
+
+namespace DeltaOta {
+
+void begin() {
+    if (listening) return;
+    server.begin();
+    listening = true;
+    Serial.printf("Delta OTA listening on port %u\n", (unsigned)PORT);
+}
+
+void poll() {
+    if (restartPending) {
+        if (allLanesStopped()) ESP.restart();
+        return;
+    }
+    if (!listening) return;
+
+    if (!applier) {
+        WiFiClient next = server.available();
+        if (!next) return;
+        client = next;
+        source.partition = esp_ota_get_running_partition();
+        applier = new (applierStorage) PatchApplier(source, sink);
+        machineStopped = false;
+        holdStartMs = millis();
+        requestHold(HOLD_DELTA_OTA, true);   // Finish the current part, then stay in IDLE
+        Serial.println("Delta OTA: waiting for the machine to stop");
+    }
+
+    // esp_ota_begin() erases the slot, which stalls flash access on both
+    // cores: nothing is read from the client (TCP holds the sender back)
+    // until no lane is mid-cycle
+    if (!machineStopped) {
+        if (!allLanesStopped()) {
+            if (millis() - holdStartMs >= STOP_TIMEOUT_MS) failSession("machine did not stop");
+            return;
+        }
+        machineStopped = true;
+        lastDataMs = millis();
+        Serial.println("Delta OTA: machine stopped, receiving patch");
+    }
+
+    // Bounded work per poll so the rest of the network task keeps running
+    for (int i = 0; i < 8 && client.available() > 0; i++) {
+        const int length = client.read(chunk, sizeof(chunk));
+        if (length <= 0) break;
+        lastDataMs = millis();
+
+        const PatchApplier::Status status = applier->feed(chunk, (size_t)length);
+        if (status == PatchApplier::PATCH_DONE) {
+            finishSession();
+            return;
+        }
+        if (status != PatchApplier::PATCH_NEED_MORE) {
+            failSession(PatchApplier::statusText(status));
+            return;
+        }
+    }
+
+    if (!client.connected() && client.available() <= 0) {
+        failSession("connection closed before end of patch");
+    } else if (millis() - lastDataMs >= SESSION_IDLE_TIMEOUT_MS) {
+        failSession("timed out waiting for data");
+    }
+}
+
+} // namespace DeltaOta
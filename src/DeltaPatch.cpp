@@ -0,0 +1,150 @@
+#include "DeltaPatch.h"
+#include <string.h>
+
+static uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+PatchApplier::PatchApplier(PatchSource& oldImage, PatchSink& newImage)
+    : source(oldImage), sink(newImage) {
+    memset(&hdr, 0, sizeof(hdr));
+    current = PATCH_NEED_MORE;
+    phase = PH_HEADER;
+    pendingLength = 0;
+    pendingNeeded = PATCH_HEADER_SIZE;
+    op = PATCH_END;
+    insertRemaining = 0;
+    written = 0;
+}
+
+PatchApplier::Status PatchApplier::fail(Status status) {
+    current = status;
+    phase = PH_FINISHED;
+    return status;
+}
+
+PatchApplier::Status PatchApplier::feed(const uint8_t* data, size_t length) {
+    while (length > 0 && current == PATCH_NEED_MORE) {
+        switch (phase) {
+            case PH_HEADER:
+            case PH_OP_ARGS: {
+                // Collect a fixed-size field that may straddle chunks
+                const size_t take = length < pendingNeeded - pendingLength ? length : pendingNeeded - pendingLength;
+                memcpy(pending + pendingLength, data, take);
+                pendingLength += take;
+                data += take;
+                length -= take;
+                if (pendingLength < pendingNeeded) break;
+                if (phase == PH_HEADER) parseHeader();
+                else runOp();
+                break;
+            }
+
+            case PH_OP:
+                op = *data++;
+                length--;
+                if (op == PATCH_END) {
+                    finish();
+                    break;
+                }
+                if (op != PATCH_COPY && op != PATCH_INSERT) return fail(PATCH_BAD_OP);
+                phase = PH_OP_ARGS;
+                pendingLength = 0;
+                pendingNeeded = op == PATCH_COPY ? 8 : 4;
+                break;
+
+            case PH_INSERT_DATA: {
+                const size_t take = length < insertRemaining ? length : insertRemaining;
+                if (emit(data, take) != PATCH_NEED_MORE) return current;
+                data += take;
+                length -= take;
+                insertRemaining -= take;
+                if (insertRemaining == 0) phase = PH_OP;
+                break;
+            }
+
+            case PH_FINISHED:
+                return current;
+        }
+    }
+    if (length > 0 && current == PATCH_DONE) return fail(PATCH_TRAILING_DATA);
+    return current;
+}
+
+PatchApplier::Status PatchApplier::parseHeader() {
+    if (getU32(pending) != PATCH_MAGIC || pending[4] != PATCH_VERSION) return fail(PATCH_BAD_HEADER);
+    hdr.oldSize = getU32(pending + 8);
+    hdr.newSize = getU32(pending + 12);
+    memcpy(hdr.oldHash, pending + 16, Sha256::DIGEST_SIZE);
+    memcpy(hdr.newHash, pending + 48, Sha256::DIGEST_SIZE);
+
+    // Refuse to touch the target unless we're patching the image the patch was made from
+    Sha256 oldHash;
+    for (uint32_t offset = 0; offset < hdr.oldSize; offset += COPY_BUFFER) {
+        const size_t chunk = hdr.oldSize - offset < COPY_BUFFER ? hdr.oldSize - offset : COPY_BUFFER;
+        if (!source.read(offset, copyBuffer, chunk)) return fail(PATCH_IO_ERROR);
+        oldHash.update(copyBuffer, chunk);
+    }
+    uint8_t digest[Sha256::DIGEST_SIZE];
+    oldHash.finish(digest);
+    if (memcmp(digest, hdr.oldHash, sizeof(digest)) != 0) return fail(PATCH_WRONG_BASE);
+
+    if (!sink.begin(hdr.newSize)) return fail(PATCH_IO_ERROR);
+    phase = PH_OP;
+    return current;
+}
+
+PatchApplier::Status PatchApplier::runOp() {
+    if (op == PATCH_INSERT) {
+        insertRemaining = getU32(pending);
+        phase = insertRemaining ? PH_INSERT_DATA : PH_OP;
+        return current;
+    }
+
+    // COPY: stream the range out of the old image through the copy buffer
+    const uint32_t offset = getU32(pending);
+    uint32_t remaining = getU32(pending + 4);
+    if (offset > hdr.oldSize || remaining > hdr.oldSize - offset) return fail(PATCH_OUT_OF_RANGE);
+    for (uint32_t at = offset; remaining > 0;) {
+        const size_t chunk = remaining < COPY_BUFFER ? remaining : COPY_BUFFER;
+        if (!source.read(at, copyBuffer, chunk)) return fail(PATCH_IO_ERROR);
+        if (emit(copyBuffer, chunk) != PATCH_NEED_MORE) return current;
+        at += chunk;
+        remaining -= chunk;
+    }
+    phase = PH_OP;
+    return current;
+}
+
+PatchApplier::Status PatchApplier::emit(const uint8_t* data, size_t length) {
+    if (length > hdr.newSize - written) return fail(PATCH_OUT_OF_RANGE);
+    if (!sink.write(data, length)) return fail(PATCH_IO_ERROR);
+    newHash.update(data, length);
+    written += length;
+    return current;
+}
+
+PatchApplier::Status PatchApplier::finish() {
+    if (written != hdr.newSize) return fail(PATCH_OUT_OF_RANGE);
+    uint8_t digest[Sha256::DIGEST_SIZE];
+    newHash.finish(digest);
+    if (memcmp(digest, hdr.newHash, sizeof(digest)) != 0) return fail(PATCH_HASH_MISMATCH);
+    current = PATCH_DONE;
+    phase = PH_FINISHED;
+    return current;
+}
+
+const char* PatchApplier::statusText(Status status) {
+    switch (status) {
+        case PATCH_NEED_MORE:     return "incomplete";
+        case PATCH_DONE:          return "ok";
+        case PATCH_BAD_HEADER:    return "not a patch (bad header)";
+        case PATCH_WRONG_BASE:    return "patch was made for a different running image";
+        case PATCH_BAD_OP:        return "corrupt patch (bad op)";
+        case PATCH_OUT_OF_RANGE:  return "corrupt patch (out of range)";
+        case PATCH_IO_ERROR:      return "flash read/write failed";
+        case PATCH_HASH_MISMATCH: return "rebuilt image failed hash check";
+        case PATCH_TRAILING_DATA: return "data after end of patch";
+    }
+    return "?";
+}
@@ -0,0 +1,4 @@
+#include "EdgeInput.h"
+
+// Set by whoever consumes the edges (the control task on target)
+EdgeWakeHook edgeWakeHook = nullptr;
@@ -0,0 +1,84 @@
+#include "Logger.h"
+#include <atomic>
+#include "hal/Hal.h"
+#include "SpscQueue.h"
+
+//* ************************************************************************
+//* ************************** EVENT FORMATS ******************************
+//* ************************************************************************
+#define LOG_EVENT_FORMAT(id, fmt) fmt,
+static const char* const EVENT_FORMATS[EV_COUNT] = { LOG_EVENTS(LOG_EVENT_FORMAT) };
+#undef LOG_EVENT_FORMAT
+
+//* ************************************************************************
+//* *************************** RING BUFFER *******************************
+//* ************************************************************************
+static SpscQueue<LogRecord, Logger::RING_SIZE> ring;
+static std::atomic<uint32_t> dropped(0);
+static uint32_t reportedDrops = 0;        // Consumer side only
+
+namespace Logger {
+
+bool push(uint16_t event, uint8_t lane, uint8_t state, uint8_t step, int32_t arg0, int32_t arg1) {
+    const LogRecord r = { hal::Clock::micros(), (uint8_t)event, lane, state, step, arg0, arg1 };
+    if (!ring.push(r)) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void drain() {
+    LogRecord r;
+    while (ring.pop(r)) {
+        Serial.printf("[%7lu.%03lu] ", (unsigned long)(r.timeUs / 1000), (unsigned long)(r.timeUs % 1000));
+        if (r.lane != LOG_NO_LANE) Serial.printf("L%u ", (unsigned)r.lane);
+        if (r.event < EV_COUNT) {
+            Serial.printf(EVENT_FORMATS[r.event], (long)r.arg0, (long)r.arg1);
+        } else {
+            Serial.printf("Unknown log event %u", (unsigned)r.event);
+        }
+        Serial.println();
+    }
+
+    const uint32_t drops = dropped.load(std::memory_order_relaxed);
+    if (drops != reportedDrops) {
+        Serial.printf("[log] %lu records dropped (ring full)\n", (unsigned long)(drops - reportedDrops));
+        reportedDrops = drops;
+    }
+}
+
+uint32_t droppedCount() {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+//* ************************************************************************
+//* *************************** DRAIN TASK ********************************
+//* ************************************************************************
+#if defined(ROUTER_NATIVE)
+
+// The native runner calls drain() itself after each simulated tick
+void init() {}
+
+#else
+
+const uint32_t DRAIN_PERIOD_MS = 10;
+const uint32_t DRAIN_TASK_STACK = 4096;
+const UBaseType_t DRAIN_TASK_PRIORITY = 1;   // Just above idle
+const BaseType_t DRAIN_TASK_CORE = 0;        // Keep formatting off the loop() core
+
+static void drainTask(void*) {
+    for (;;) {
+        drain();
+        vTaskDelay(pdMS_TO_TICKS(DRAIN_PERIOD_MS));
+    }
+}
+
+void init() {
+    xTaskCreatePinnedToCore(drainTask, "logDrain", DRAIN_TASK_STACK, nullptr,
+                            DRAIN_TASK_PRIORITY, nullptr, DRAIN_TASK_CORE);
+}
+
+#endif
+
+} // namespace Logger
@@ -0,0 +1,66 @@
+#include "LoopProfiler.h"
+#include "hal/Hal.h"
+#include "Seqlock.h"
+
+// Live data, written only by the owning loop's task
+static LoopProfiler::LoopCounters loops[LoopProfiler::LOOP_COUNT];
+static Histogram sections[LoopProfiler::SEC_COUNT];
+
+// Copies for readers on other tasks
+static Seqlock<LoopProfiler::LoopCounters> publishedLoops[LoopProfiler::LOOP_COUNT];
+static Seqlock<Histogram> publishedSections[LoopProfiler::SEC_COUNT];
+
+// The loop whose task writes each section
+static const LoopProfiler::Loop SECTION_OWNER[LoopProfiler::SEC_COUNT] = {
+    LoopProfiler::LOOP_CONTROL, LoopProfiler::LOOP_CONTROL, LoopProfiler::LOOP_NETWORK
+};
+
+static const char* const LOOP_NAMES[LoopProfiler::LOOP_COUNT] = { "control", "network" };
+static const char* const SECTION_NAMES[LoopProfiler::SEC_COUNT] = { "inputs", "stateMachine", "ota" };
+
+namespace LoopProfiler {
+
+void recordIteration(Loop loop, uint32_t costUs) {
+    LoopCounters& c = loops[loop];
+    const uint32_t now = hal::Clock::micros();
+    c.iterations++;
+    if (costUs > c.worstUs) c.worstUs = costUs;
+
+    // Roll the iterations-per-second window
+    c.windowCount++;
+    if (now - c.windowStartUs >= 1000000UL) {
+        c.perSecond = c.windowCount;
+        c.windowCount = 0;
+        c.windowStartUs = now;
+        publish(loop);
+    }
+}
+
+void publish(Loop loop) {
+    publishedLoops[loop].write(loops[loop]);
+    for (int i = 0; i < SEC_COUNT; i++) {
+        if (SECTION_OWNER[i] == loop) publishedSections[i].write(sections[i]);
+    }
+}
+
+void recordSection(Section section, uint32_t us) {
+    sections[section].record(us);
+}
+
+LoopCounters loopCounters(Loop loop) {
+    return publishedLoops[loop].read();
+}
+
+void readSection(Section section, Histogram& out) {
+    while (!publishedSections[section].tryRead(out)) {}
+}
+
+const char* loopName(Loop loop) {
+    return LOOP_NAMES[loop];
+}
+
+const char* sectionName(Section section) {
+    return SECTION_NAMES[section];
+}
+
+} // namespace LoopProfiler
@@ -0,0 +1,103 @@
+#include "MotionProfile.h"
+#include <math.h>
+
+MotionProfile::MotionProfile() {
+    segmentCount = 0;
+    startAngle = 0.0f;
+    endAngle = 0.0f;
+    direction = 1.0f;
+    totalUs = 0;
+}
+
+// Append a segment that starts where the previous one ends
+void MotionProfile::addSegment(float duration, float a0, float jerk) {
+    if (duration <= 1e-7f || segmentCount >= MAX_SEGMENTS) return;
+
+    float p0 = 0.0f;
+    float v0 = 0.0f;
+    if (segmentCount > 0) {
+        const Segment& prev = segments[segmentCount - 1];
+        const float d = prev.duration;
+        p0 = prev.p0 + prev.v0 * d + prev.a0 * d * d / 2.0f + prev.jerk * d * d * d / 6.0f;
+        v0 = prev.v0 + prev.a0 * d + prev.jerk * d * d / 2.0f;
+    }
+    segments[segmentCount++] = { duration, p0, v0, a0, jerk };
+}
+
+// Shape of the acceleration phase needed to reach peak velocity v
+static void accelPhase(float v, const MotionLimits& limits, float& tj, float& ta, float& aPeak) {
+    const float a = limits.maxAccel;
+    const float j = limits.maxJerk;
+    if (j <= 0.0f) {
+        tj = 0.0f;                 // Trapezoid: step change in acceleration
+        aPeak = a;
+        ta = v / a;
+    } else if (v * j >= a * a) {
+        tj = a / j;                // Jerk ramps, then constant acceleration
+        aPeak = a;
+        ta = tj + v / a;
+    } else {
+        tj = sqrtf(v / j);         // Acceleration limit never reached
+        aPeak = j * tj;
+        ta = 2.0f * tj;
+    }
+}
+
+void MotionProfile::plan(float fromAngle, float toAngle, const MotionLimits& limits) {
+    startAngle = fromAngle;
+    endAngle = toAngle;
+    direction = toAngle >= fromAngle ? 1.0f : -1.0f;
+    segmentCount = 0;
+    totalUs = 0;
+
+    const float distance = fabsf(toAngle - fromAngle);
+    if (distance <= 0.0f || limits.maxVelocity <= 0.0f || limits.maxAccel <= 0.0f) return;
+
+    // Accelerating to maxVelocity and back covers vPeak * ta; if that overshoots
+    // the move, bisect for the highest peak velocity that fits
+    float vPeak = limits.maxVelocity;
+    float tj, ta, aPeak;
+    accelPhase(vPeak, limits, tj, ta, aPeak);
+    if (vPeak * ta > distance) {
+        float lo = 0.0f;
+        float hi = vPeak;
+        for (int i = 0; i < 40; i++) {
+            const float mid = (lo + hi) / 2.0f;
+            accelPhase(mid, limits, tj, ta, aPeak);
+            if (mid * ta > distance) hi = mid;
+            else lo = mid;
+        }
+        vPeak = lo;
+        accelPhase(vPeak, limits, tj, ta, aPeak);
+    }
+    if (vPeak <= 0.0f) return;
+
+    float tv = distance / vPeak - ta;
+    if (tv < 0.0f) tv = 0.0f;
+
+    const float j = limits.maxJerk;
+    addSegment(tj, 0.0f, j);                 // Jerk up
+    addSegment(ta - 2.0f * tj, aPeak, 0.0f); // Constant acceleration
+    addSegment(tj, aPeak, -j);               // Jerk down to cruise
+    addSegment(tv, 0.0f, 0.0f);              // Cruise at vPeak
+    addSegment(tj, 0.0f, -j);                // Jerk into deceleration
+    addSegment(ta - 2.0f * tj, -aPeak, 0.0f);// Constant deceleration
+    addSegment(tj, -aPeak, j);               // Jerk back to rest
+
+    totalUs = (uint32_t)ceilf((2.0f * ta + tv) * 1e6f);
+}
+
+float MotionProfile::angleAt(uint32_t elapsedUs) const {
+    if (segmentCount == 0 || elapsedUs >= totalUs) return endAngle;
+
+    float t = elapsedUs * 1e-6f;
+    for (uint8_t i = 0; i < segmentCount; i++) {
+        const Segment& s = segments[i];
+        if (t < s.duration) {
+            const float p = s.p0 + s.v0 * t + s.a0 * t * t / 2.0f + s.jerk * t * t * t / 6.0f;
+            return startAngle + direction * p;
+        }
+        t -= s.duration;
+    }
+    return endAngle;
+}
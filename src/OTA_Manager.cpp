@@ -2,11 +2,22 @@
 //* ************************ OTA MANAGER **********************************
 //* ************************************************************************
 //! Simple OTA (Over-The-Air) update manager for ESP32
-//! Handles WiFi connection and OTA updates
+//! Handles WiFi connection and OTA updates. All network work runs in its
+//! own task on core 0 so it can never delay the control task on core 1.
+//! Bring-up is event driven: setup() returns at once, the machine can cycle
+//! immediately, and a missing AP only costs background retries with backoff.
 
 #include <WiFi.h>
 #include <ArduinoOTA.h>
 #include <Arduino.h>
+#include <atomic>
+#include "OTA_Manager.h"
+#include "StateMachine/StateMachine.h"
+#include "LoopProfiler.h"
+#include "SerialCommands.h"
+#include "CommandUdp.h"
+#include "DeltaOta.h"
+#include "Telemetry.h"
 
 // WiFi credentials
 const char* WIFI_SSID = "Everwood";
@@ -15,40 +26,60 @@ const char* WIFI_PASSWORD = "Everwood-Staff";
 // OTA settings
 const char* OTA_HOSTNAME = "Router-July25-ESP32";
 const char* OTA_PASSWORD = "";  // No password for simplicity
+const uint32_t OTA_STOP_TIMEOUT_MS = 8000;  // Inside espota's 10 s wait for the device to connect
+
+// Connection retry settings
+const uint32_t WIFI_CONNECT_TIMEOUT_MS = 10000;  // Give up on one attempt after this long
+const uint32_t WIFI_BACKOFF_MIN_MS = 1000;       // First retry delay
+const uint32_t WIFI_BACKOFF_MAX_MS = 60000;      // Retry delay cap (doubles each failure)
+
+// Network task settings
+const uint32_t NETWORK_POLL_MS = 10;
+const uint32_t NETWORK_TASK_STACK = 8192;
+const UBaseType_t NETWORK_TASK_PRIORITY = 2;
+const BaseType_t NETWORK_TASK_CORE = 0;     // Same core as the WiFi stack
 
 //* ************************************************************************
-//* ************************ OTA INITIALIZATION ***************************
+//* ********************** CONNECTION STATE *******************************
 //* ************************************************************************
 
-void initOTA() {
-    Serial.println("=== STARTING OTA SETUP ===");
-    
-    // Connect to WiFi
-    Serial.print("Connecting to WiFi: ");
-    Serial.println(WIFI_SSID);
-    
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-    
-    // Wait for WiFi connection (max 10 seconds)
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-        delay(500);
-        Serial.print(".");
-        attempts++;
-    }
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println();
-        Serial.print("✓ WiFi connected! IP address: ");
-        Serial.println(WiFi.localIP());
-    } else {
-        Serial.println();
-        Serial.println("✗ WiFi connection failed - OTA disabled");
-        return;
+enum NetState { NET_CONNECTING, NET_BACKOFF, NET_READY };
+
+static NetState netState = NET_CONNECTING;     // Network task only
+static uint32_t netStateStartMs = 0;
+static uint32_t backoffMs = WIFI_BACKOFF_MIN_MS;
+static bool otaConfigured = false;
+static uint32_t bootMs = 0;
+static uint32_t linkLostMs = 0;
+
+// Written by the WiFi event task, consumed by the network task
+static std::atomic<bool> gotIpEvent(false);
+static std::atomic<bool> disconnectEvent(false);
+
+// Read from any task
+static std::atomic<bool> readyFlag(false);
+static std::atomic<uint32_t> timeToReadyMs(0);
+static std::atomic<uint32_t> reconnectMs(0);
+
+static void onWiFiEvent(arduino_event_id_t event) {
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+        gotIpEvent.store(true);
+    } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+        disconnectEvent.store(true);
     }
-    
-    // Configure OTA
+}
+
+static void enterState(NetState next) {
+    netState = next;
+    netStateStartMs = millis();
+}
+
+//* ************************************************************************
+//* ************************ OTA INITIALIZATION ***************************
+//* ************************************************************************
+
+// Register ArduinoOTA handlers; done once, the first time the link comes up
+static void configureOTA() {
     ArduinoOTA.setHostname(OTA_HOSTNAME);
     if (strlen(OTA_PASSWORD) > 0) {
         ArduinoOTA.setPassword(OTA_PASSWORD);
@@ -63,6 +94,21 @@ void initOTA() {
             type = "filesystem";
         }
         Serial.println("OTA Update starting: " + type);
+
+        // Writing flash stalls both cores, so nothing may be written while
+        // a lane is mid-cycle. Nothing has been written yet; hold here
+        // until every lane is at rest, as the delta path does.
+        requestHold(HOLD_ARDUINO_OTA, true);
+        const uint32_t holdStartMs = millis();
+        while (!allLanesStopped()) {
+            if (millis() - holdStartMs >= OTA_STOP_TIMEOUT_MS) {
+                // Fails every write, so the session ends in onError()
+                Serial.println("OTA refused: machine did not stop");
+                Update.abort();
+                return;
+            }
+            vTaskDelay(pdMS_TO_TICKS(NETWORK_POLL_MS));
+        }
     });
     
     ArduinoOTA.onEnd([]() {
@@ -86,13 +132,84 @@ void initOTA() {
         } else if (error == OTA_END_ERROR) {
             Serial.println("End Failed");
         }
+        requestHold(HOLD_ARDUINO_OTA, false);
     });
     
-    ArduinoOTA.begin();
-    Serial.println("✓ OTA ready!");
-    Serial.print("OTA hostname: ");
-    Serial.println(OTA_HOSTNAME);
-    Serial.println("=== OTA SETUP COMPLETE ===");
+    otaConfigured = true;
+}
+
+void initOTA() {
+    Serial.println("=== STARTING OTA SETUP ===");
+    Serial.print("Connecting to WiFi in the background: ");
+    Serial.println(WIFI_SSID);
+
+    bootMs = millis();
+    WiFi.onEvent(onWiFiEvent);
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false);  // Reconnects are paced by our own backoff
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    enterState(NET_CONNECTING);
+}
+
+//* ************************************************************************
+//* ********************* CONNECTION STATE MACHINE ************************
+//* ************************************************************************
+
+static void handleNetwork() {
+    const uint32_t now = millis();
+    const bool disconnected = disconnectEvent.exchange(false);
+
+    if (disconnected && netState == NET_READY) {
+        Serial.println("✗ WiFi link lost - OTA paused");
+        ArduinoOTA.end();
+        readyFlag.store(false);
+        linkLostMs = now;
+        backoffMs = WIFI_BACKOFF_MIN_MS;
+        enterState(NET_BACKOFF);
+    }
+
+    switch (netState) {
+        case NET_CONNECTING:
+            if (gotIpEvent.exchange(false)) {
+                if (!otaConfigured) configureOTA();
+                ArduinoOTA.begin();
+                CommandUdp::begin();
+                DeltaOta::begin();
+                readyFlag.store(true);
+                backoffMs = WIFI_BACKOFF_MIN_MS;
+                enterState(NET_READY);
+
+                Serial.print("✓ WiFi connected! IP address: ");
+                Serial.println(WiFi.localIP());
+                Serial.print("OTA hostname: ");
+                Serial.println(OTA_HOSTNAME);
+                if (timeToReadyMs.load() == 0) {
+                    timeToReadyMs.store(now - bootMs);
+                    Serial.printf("=== OTA READY %lu ms after boot ===\n", (unsigned long)(now - bootMs));
+                } else {
+                    reconnectMs.store(now - linkLostMs);
+                    Serial.printf("=== OTA READY again %lu ms after link loss ===\n", (unsigned long)(now - linkLostMs));
+                }
+            } else if (disconnected || now - netStateStartMs >= WIFI_CONNECT_TIMEOUT_MS) {
+                Serial.printf("✗ WiFi connection failed - retrying in %lu ms\n", (unsigned long)backoffMs);
+                WiFi.disconnect();
+                disconnectEvent.store(false);
+                enterState(NET_BACKOFF);
+            }
+            break;
+
+        case NET_BACKOFF:
+            if (now - netStateStartMs >= backoffMs) {
+                backoffMs = backoffMs * 2 > WIFI_BACKOFF_MAX_MS ? WIFI_BACKOFF_MAX_MS : backoffMs * 2;
+                gotIpEvent.store(false);
+                WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+                enterState(NET_CONNECTING);
+            }
+            break;
+
+        case NET_READY:
+            break;
+    }
 }
 
 //* ************************************************************************
@@ -100,5 +217,43 @@ void initOTA() {
 //* ************************************************************************
 
 void handleOTA() {
+    if (!readyFlag.load(std::memory_order_relaxed)) return;
     ArduinoOTA.handle();
-} 
\ No newline at end of file
+}
+
+bool networkReady() {
+    return readyFlag.load();
+}
+
+uint32_t otaTimeToReadyMs() {
+    return timeToReadyMs.load();
+}
+
+uint32_t otaLastReconnectMs() {
+    return reconnectMs.load();
+}
+
+//* ************************************************************************
+//* ************************ NETWORK TASK *********************************
+//* ************************************************************************
+
+static void networkTask(void*) {
+    for (;;) {
+        const uint32_t startUs = micros();
+        handleNetwork();
+        PROFILE_SECTION(SEC_OTA, handleOTA());
+        SerialCommands::poll();
+        if (networkReady()) {
+            CommandUdp::poll();
+            DeltaOta::poll();
+            Telemetry::poll(millis());
+        }
+        LoopProfiler::recordIteration(LoopProfiler::LOOP_NETWORK, micros() - startUs);
+        vTaskDelay(pdMS_TO_TICKS(NETWORK_POLL_MS));
+    }
+}
+
+void startNetworkTask() {
+    xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK, nullptr,
+                            NETWORK_TASK_PRIORITY, nullptr, NETWORK_TASK_CORE);
+}
@@ -0,0 +1,265 @@
+#include "SerialCommands.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal/Hal.h"
+#include "LoopProfiler.h"
+#include "StateMachine/StateMachine.h"
+#include "config/Params.h"
+#include "Telemetry.h"
+#include "TraceRing.h"
+
+const int COMMAND_LINE_MAX = 64;
+static char line[COMMAND_LINE_MAX];
+static int lineLength = 0;
+
+void CommandOutput::printf(const char* fmt, ...) {
+    char text[160];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+    write(text);
+}
+
+struct SerialOutput : CommandOutput {
+    void write(const char* text) override { Serial.print(text); }
+};
+
+static SerialOutput serialOutput;
+
+// Lane stats are copied here from the control task's snapshot; too big for
+// the network task's stack
+static LaneStatsSnapshot snapshot;
+static Histogram sectionSnapshot;
+
+// One histogram as a table row: count, p50, p95, p99, max (microseconds)
+static void printRow(CommandOutput& out, const char* name, const Histogram& h) {
+    out.printf("  %-20s %8lu %10lu %10lu %10lu %10lu\n", name,
+               (unsigned long)h.count(), (unsigned long)h.percentile(500),
+               (unsigned long)h.percentile(950), (unsigned long)h.percentile(990),
+               (unsigned long)h.max());
+}
+
+static void printHeader(CommandOutput& out, const char* title) {
+    out.printf("%-22s %8s %10s %10s %10s %10s\n", title, "n", "p50 us", "p95 us", "p99 us", "max us");
+}
+
+namespace SerialCommands {
+
+StatsSection platformStats = nullptr;
+
+void printStats(CommandOutput& out) {
+    out.printf("=== STATS at %lu ms ===\n", (unsigned long)hal::Clock::millis());
+
+    for (int id = 0; id < LANE_COUNT; id++) {
+        LaneStatsSnapshot& lane = snapshot;
+        readLaneStats(id, lane);
+        out.printf("--- Lane %d ---\n", id);
+        printHeader(out, "Step");
+        for (int i = 0; i < ST_COUNT; i++) {
+            printRow(out, stepDef((StepId)i).name, lane.stepStats[i].durationUs);
+        }
+
+        printHeader(out, "State");
+        for (int i = S_IDLE; i < S_COUNT; i++) {
+            printRow(out, stateName((State)i), lane.stateDurationUs[i]);
+        }
+
+        printHeader(out, "Cycle");
+        printRow(out, "start to IDLE", lane.cycleTimeUs);
+        printRow(out, lane.flipMoveMeasured ? "flip move (measured)" : "flip move (model)", lane.flipMoveUs);
+
+        out.printf("Step timeouts:");
+        for (int i = 0; i < ST_COUNT; i++) {
+            const uint32_t timeouts = lane.stepStats[i].timeouts;
+            if (timeouts) out.printf(" %s=%lu", stepDef((StepId)i).name, (unsigned long)timeouts);
+        }
+        out.printf("\nFaults: %lu (%u automatic retries in a row)%s\n", (unsigned long)lane.faults,
+                   lane.faultRetries, lane.state == S_FAULT ? ", IN FAULT NOW" : "");
+        out.printf("Start triggers: %lu latched, %lu coalesced, %lu dropped, %d waiting\n",
+                   (unsigned long)lane.triggersLatched, (unsigned long)lane.triggersCoalesced,
+                   (unsigned long)lane.triggersDropped, lane.triggersQueued);
+    }
+
+    out.printf("--- Controller ---\n");
+    printHeader(out, "Section");
+    for (int i = 0; i < LoopProfiler::SEC_COUNT; i++) {
+        const LoopProfiler::Section section = (LoopProfiler::Section)i;
+        LoopProfiler::readSection(section, sectionSnapshot);
+        printRow(out, LoopProfiler::sectionName(section), sectionSnapshot);
+    }
+
+    out.printf("%-22s %10s %10s %10s\n", "Loop", "total", "per sec", "worst us");
+    for (int i = 0; i < LoopProfiler::LOOP_COUNT; i++) {
+        const LoopProfiler::Loop loop = (LoopProfiler::Loop)i;
+        const LoopProfiler::LoopCounters c = LoopProfiler::loopCounters(loop);
+        out.printf("  %-20s %10lu %10lu %10lu\n", LoopProfiler::loopName(loop),
+                   (unsigned long)c.iterations, (unsigned long)c.perSecond, (unsigned long)c.worstUs);
+    }
+
+    out.printf("Log records dropped: %lu\n", (unsigned long)Logger::droppedCount());
+    out.printf("Telemetry: %lu datagrams sent, %lu records dropped\n",
+               (unsigned long)Telemetry::sentDatagrams(), (unsigned long)Telemetry::droppedCount());
+    if (platformStats) platformStats(out);
+}
+
+// Optional leading lane number: advances `args` past it and sets the range
+// [first, last] it selects; with no number, every lane is selected
+static bool parseLanes(const char*& args, int& first, int& last, CommandOutput& out) {
+    first = 0;
+    last = LANE_COUNT - 1;
+    while (*args == ' ') args++;
+    if (*args < '0' || *args > '9') return true;
+
+    char* end = nullptr;
+    const long lane = strtol(args, &end, 10);
+    if (*end != ' ' && *end != '\0') return true;   // Not a lane number after all
+    if (lane >= LANE_COUNT) {
+        out.printf("No lane %ld (lanes 0-%d)\n", lane, LANE_COUNT - 1);
+        return false;
+    }
+    first = last = (int)lane;
+    args = end;
+    return true;
+}
+
+static void printParams(const char* args, CommandOutput& out) {
+    int first, last;
+    if (!parseLanes(args, first, last, out)) return;
+
+    for (int lane = first; lane <= last; lane++) {
+        const MachineParams active = Params::active(lane);
+        const MachineParams staged = Params::staged(lane);
+        out.printf("--- Lane %d ---\n", lane);
+        out.printf("%-16s %12s %12s %12s %12s\n", "Parameter", "active", "staged", "min", "max");
+        for (int i = 0; i < Params::count(); i++) {
+            const int decimals = Params::isInteger(i) ? 0 : 3;
+            out.printf("  %-14s %12.*f %12.*f %12.*f %12.*f\n", Params::name(i),
+                       decimals, Params::value(active, i), decimals, Params::value(staged, i),
+                       decimals, Params::minValue(i), decimals, Params::maxValue(i));
+        }
+        if (Params::pending(lane)) out.printf("Staged changes apply when the lane is next in IDLE\n");
+    }
+}
+
+static void setParam(const char* args, CommandOutput& out) {
+    int first, last;
+    if (!parseLanes(args, first, last, out)) return;
+
+    char name[32];
+    char valueText[32];
+    if (sscanf(args, "%31s %31s", name, valueText) != 2) {
+        out.printf("Usage: set [lane] <name> <value>\n");
+        return;
+    }
+    char* end = nullptr;
+    const float value = strtof(valueText, &end);
+    if (end == valueText || *end != '\0') {
+        out.printf("Not a number: '%s'\n", valueText);
+        return;
+    }
+    for (int lane = first; lane <= last; lane++) {
+        const Params::Result result = Params::stage(lane, name, value);
+        if (result == Params::PARAM_OK) out.printf("Lane %d: %s = %g staged\n", lane, name, value);
+        else out.printf("Lane %d: %s not changed: %s\n", lane, name, Params::resultText(result));
+    }
+    wakeControl();   // An idle lane applies staged values straight away
+}
+
+static void stageDefaults(const char* args, CommandOutput& out) {
+    int first, last;
+    if (!parseLanes(args, first, last, out)) return;
+
+    for (int lane = first; lane <= last; lane++) {
+        Params::stageDefaults(lane);
+        out.printf("Lane %d: defaults staged\n", lane);
+    }
+    wakeControl();
+}
+
+static void clearFaults(const char* args, CommandOutput& out) {
+    int first, last;
+    if (!parseLanes(args, first, last, out)) return;
+
+    for (int lane = first; lane <= last; lane++) {
+        readLaneStats(lane, snapshot);
+        if (snapshot.state != S_FAULT) continue;
+        requestFaultClear(lane);
+        out.printf("Lane %d: fault cleared\n", lane);
+    }
+}
+
+static const char* const FAULT_NAMES[] = { "-", "watchdog", "feed jam" };
+
+void printTrace(CommandOutput& out, bool lastBoot) {
+    static TraceSnapshot live;   // Network task only
+    if (!lastBoot) TraceRing::current(live);
+    const TraceSnapshot& trace = lastBoot ? TraceRing::lastBoot() : live;
+
+    if (!trace.valid) {
+        out.printf("No trace from the last boot (power-on reset)\n");
+        return;
+    }
+    if (lastBoot) {
+        out.printf("=== TRACE: boot %lu, ended by %s reset; last %lu of %lu transitions ===\n",
+                   (unsigned long)trace.boot, TraceRing::resetReasonName(trace.resetReason),
+                   (unsigned long)trace.count, (unsigned long)trace.total);
+    } else {
+        out.printf("=== TRACE: this boot (%lu); last %lu of %lu transitions ===\n", (unsigned long)trace.boot,
+                   (unsigned long)trace.count, (unsigned long)trace.total);
+    }
+    out.printf("%10s %4s %-20s %5s %6s %7s %6s  %s\n", "ms", "lane", "step", "cyl", "servo", "angle", "cycle", "fault");
+    for (uint32_t i = 0; i < trace.count; i++) {
+        const TraceEntry& e = trace.entries[i];
+        const char* step = e.step < ST_COUNT ? stepDef((StepId)e.step).name : "?";
+        const char* fault = e.fault < sizeof(FAULT_NAMES) / sizeof(FAULT_NAMES[0]) ? FAULT_NAMES[e.fault] : "?";
+        out.printf("%10lu %4u %-20s %5s %6s %7.1f %6u  %s\n", (unsigned long)e.timeMs, e.lane, step,
+                   e.outputs & TRACE_OUT_CYLINDER ? "on" : "off", e.outputs & TRACE_OUT_SERVO_MOVING ? "moving" : "-",
+                   e.servoDeciDeg / 10.0f, e.cycle, fault);
+    }
+}
+
+void execute(const char* command) {
+    execute(command, serialOutput);
+}
+
+void execute(const char* command, CommandOutput& out) {
+    if (strcmp(command, "stats") == 0) {
+        printStats(out);
+    } else if (strcmp(command, "params") == 0 || strncmp(command, "params ", 7) == 0) {
+        printParams(command + 6, out);
+    } else if (strncmp(command, "set ", 4) == 0) {
+        setParam(command + 4, out);
+    } else if (strcmp(command, "defaults") == 0 || strncmp(command, "defaults ", 9) == 0) {
+        stageDefaults(command + 8, out);
+    } else if (strcmp(command, "clear") == 0 || strncmp(command, "clear ", 6) == 0) {
+        clearFaults(command + 5, out);
+    } else if (strcmp(command, "trace") == 0) {
+        printTrace(out, true);
+    } else if (strcmp(command, "trace now") == 0) {
+        printTrace(out, false);
+    } else if (strcmp(command, "help") == 0) {
+        out.printf("Commands: stats, params [lane], set [lane] <name> <value>, defaults [lane], clear [lane], "
+                   "trace [now], help\n");
+    } else if (command[0] != '\0') {
+        out.printf("Unknown command '%s' (try 'help')\n", command);
+    }
+}
+
+void poll() {
+    while (Serial.available() > 0) {
+        const int c = Serial.read();
+        if (c < 0) break;
+        if (c == '\r' || c == '\n') {
+            line[lineLength] = '\0';
+            execute(line);
+            lineLength = 0;
+        } else if (lineLength < COMMAND_LINE_MAX - 1) {
+            line[lineLength++] = (char)c;
+        }
+    }
+}
+
+} // namespace SerialCommands
@@ -1,15 +1,34 @@
 #include "ServoControl.h"
-#include "config/Config.h" // Include config for SERVO_MOVE_DELAY
+#include <math.h>
+#include "config/Config.h" // Include config for servo range and default limits
+#include "Logger.h"
+
+// Built by the compiler from the servo signal range in Config.h
+static constexpr ServoPulseTable<SERVO_MIN_PULSE_US, SERVO_MAX_PULSE_US,
+                                 SERVO_MIN_ANGLE, SERVO_MAX_ANGLE> PULSE_TABLE;
+
+static_assert(SERVO_MAX_PULSE_US < 1000000 / SERVO_PWM_FREQ,
+              "SERVO_MAX_PULSE_US does not fit in one PWM frame at SERVO_PWM_FREQ");
 
 ServoControl::ServoControl() {
     pin = -1;
     channel = -1;
     frequency = 50;
     resolution = 14;
-    minPulseWidth = 500;  // Corresponds to 0 degrees
-    maxPulseWidth = 2500; // Corresponds to 180 degrees
-    minAngle = 0;
-    maxAngle = 180;
+    dutyPerUsQ16 = 0;
+    lastDuty.store(-1, std::memory_order_relaxed);
+    limits = { SERVO_MAX_VELOCITY, SERVO_MAX_ACCEL, SERVO_MAX_JERK };
+    move.startUs = 0;
+    move.rawPulseQ4 = 0;
+    arrivalUs = 0;
+    settleUs = (uint32_t)(SERVO_MOVE_DELAY * 1000.0f);
+    arriveTolerance = SERVO_ARRIVE_TOLERANCE;
+    moveId = 0;
+    logLane = LOG_NO_LANE;
+    updateTimer = hal::timer::Handle();
+    updating = false;
+    targetAngle = NAN; // Nothing commanded yet, so the first write() always goes out
+    lastUpdateTime = 0;
 }
 
 void ServoControl::init(int servoPin, int pwmChannel, int freq, int res) {
@@ -17,66 +36,202 @@ void ServoControl::init(int servoPin, int pwmChannel, int freq, int res) {
     channel = pwmChannel;
     frequency = freq;
     resolution = res;
+    lastDuty.store(-1, std::memory_order_relaxed);
+
+    // duty = pulse / period * maxDuty, folded into one multiplier
+    const uint64_t maxDuty = (1UL << resolution) - 1;
+    dutyPerUsQ16 = (uint32_t)((maxDuty * (uint64_t)frequency << 16) / 1000000UL);
     
-    ledcSetup(channel, frequency, resolution);
-    ledcAttachPin(pin, channel);
+    hal::pwm::setup(channel, frequency, resolution);
+    hal::pwm::attach(pin, channel);
+
+    // Re-evaluate the profile once per PWM frame; faster buys nothing
+    updateTimer = hal::timer::create(timerCallback, this, "servo");
+    hal::timer::start(updateTimer, 1000000UL / frequency);
+    updating = true;
 }
 
-int ServoControl::angleToDuty(float angle) {
-    if (angle < minAngle) angle = minAngle;
-    if (angle > maxAngle) angle = maxAngle;
-    
-    float pulseWidth = map(angle, minAngle, maxAngle, minPulseWidth, maxPulseWidth);
-    
-    int maxDuty = (1 << resolution) - 1;
-    int duty = (pulseWidth / (1000000.0 / frequency)) * maxDuty;
-    
-    return duty;
+uint32_t ServoControl::pulseToDuty(uint32_t pulseQ4) const {
+    return (uint32_t)(((uint64_t)pulseQ4 * dutyPerUsQ16) >> 20);
 }
 
-void ServoControl::write(float angle) {
-    if (channel >= 0) {
-        int duty = angleToDuty(angle);
-        int pulseWidth = map(angle, minAngle, maxAngle, minPulseWidth, maxPulseWidth);
-        Serial.print("Servo: Setting angle ");
-        Serial.print(angle);
-        Serial.print("°, duty=");
-        Serial.print(duty);
-        Serial.print(", pulseWidth=");
-        Serial.print(pulseWidth);
-        Serial.println("μs");
-        ledcWrite(channel, duty);
-        targetAngle = angle; // Store the target angle
-        lastUpdateTime = millis(); // Record the time of update
+uint32_t ServoControl::angleToDuty(float angle) const {
+    // Angle in 1/16 degree steps, clamped to the table range
+    int32_t angleQ4 = (int32_t)(angle * 16.0f + 0.5f) - PULSE_TABLE.MIN_ANGLE * 16;
+    if (angleQ4 < 0) angleQ4 = 0;
+    if (angleQ4 > (PULSE_TABLE.SIZE - 1) * 16) angleQ4 = (PULSE_TABLE.SIZE - 1) * 16;
+
+    const int32_t index = angleQ4 >> 4;
+    const int32_t fraction = angleQ4 & 15;
+    uint32_t pulseQ4 = PULSE_TABLE.pulseQ4[index];
+    if (fraction != 0) {
+        pulseQ4 += ((int32_t)PULSE_TABLE.pulseQ4[index + 1] - (int32_t)pulseQ4) * fraction / 16;
     }
+    return pulseToDuty(pulseQ4);
+}
+
+// Only touches the PWM peripheral when the duty actually changes
+bool ServoControl::writeDuty(uint32_t duty) {
+    if ((int32_t)duty == lastDuty.load(std::memory_order_relaxed)) return false;
+    hal::pwm::write(channel, duty);
+    lastDuty.store((int32_t)duty, std::memory_order_release);
+    return true;
+}
+
+//* ************************************************************************
+//* ************************ PROFILE HANDOFF ******************************
+//* ************************************************************************
+// The control loop is the only writer; update() skips a frame if it
+// catches a publish in progress.
+void ServoControl::publish(const MotionProfile& next, uint32_t modelledUs, uint32_t pulseQ4) {
+    move.profile = next;
+    move.startUs = hal::Clock::micros();
+    move.rawPulseQ4 = pulseQ4;
+    sharedMove.write(move);
+    arrivalUs = modelledUs;
+    lastUpdateTime = hal::Clock::millis();
+    feedback.track(++moveId, pulseQ4 != 0 ? NAN : next.targetAngle(), arriveTolerance);
+    resume();
+}
+
+void ServoControl::timerCallback(void* arg) {
+    static_cast<ServoControl*>(arg)->update();
+}
+
+void ServoControl::update() {
+    if (channel < 0) return;
+
+    Move active;
+    if (!sharedMove.tryRead(active)) return;
+
+    if (active.rawPulseQ4 != 0) writeDuty(pulseToDuty(active.rawPulseQ4));
+    else writeDuty(angleToDuty(active.profile.angleAt(hal::Clock::micros() - active.startUs)));
+}
+
+// The LEDC repeats the last duty by itself, so once a move's final duty is
+// out the per-frame update has nothing left to do and its timer need not
+// keep waking the CPU
+bool ServoControl::pause() {
+    if (!updating) return true;   // Already paused, or detached
+    if (!hasReachedTarget()) return false;
+    const uint32_t finalDuty = move.rawPulseQ4 != 0 ? pulseToDuty(move.rawPulseQ4)
+                                                    : angleToDuty(move.profile.targetAngle());
+    if (lastDuty.load(std::memory_order_acquire) != (int32_t)finalDuty) return false;
+
+    hal::timer::stop(updateTimer);
+    updating = false;
+    feedback.pause();
+    return true;
+}
+
+// Restart after pause(); the first frame goes out now rather than one
+// period later, as the timer is not running yet
+void ServoControl::resume() {
+    if (updating || channel < 0) return;
+    hal::timer::start(updateTimer, 1000000UL / frequency);
+    updating = true;
+    feedback.resume();
+    update();
+}
+
+//* ************************************************************************
+//* **************************** COMMANDS *********************************
+//* ************************************************************************
+void ServoControl::write(float angle) {
+    if (channel < 0 || (angle == targetAngle && move.rawPulseQ4 == 0)) return;
+
+    // Unprofiled jump: the servo moves at its own rated speed
+    MotionProfile jump;
+    jump.plan(angle, angle, limits);
+    const uint32_t modelledUs = (uint32_t)(fabsf(angle - currentAngle()) / SERVO_RATED_SPEED * 1e6f);
+
+    LOG_INFO(EV_SERVO_WRITE, logLane, 0, 0, (int32_t)(angle * 10.0f), (int32_t)angleToDuty(angle));
+    targetAngle = angle; // Store the target angle
+    publish(jump, modelledUs, 0);
+}
+
+void ServoControl::moveTo(float angle) {
+    if (channel < 0 || (angle == targetAngle && move.rawPulseQ4 == 0)) return;
+
+    MotionProfile next;
+    next.plan(currentAngle(), angle, limits);
+
+    LOG_INFO(EV_SERVO_MOVE, logLane, 0, 0, (int32_t)(angle * 10.0f), (int32_t)(next.durationUs() / 1000));
+    targetAngle = angle;
+    publish(next, next.durationUs(), 0);
 }
 
 void ServoControl::writeMicroseconds(int microseconds) {
-    if (channel >= 0) {
-        int maxDuty = (1 << resolution) - 1;
-        int duty = (microseconds / (1000000.0 / frequency)) * maxDuty;
-        ledcWrite(channel, duty);
-    }
+    if (channel < 0 || microseconds <= 0) return;
+
+    // Unprofiled jump to the angle this pulse stands for (clamped to the
+    // calibrated range), so the position model follows the raw pulse
+    float angle = SERVO_MIN_ANGLE + (float)(microseconds - SERVO_MIN_PULSE_US) *
+                                    (SERVO_MAX_ANGLE - SERVO_MIN_ANGLE) / (SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US);
+    if (angle < SERVO_MIN_ANGLE) angle = SERVO_MIN_ANGLE;
+    if (angle > SERVO_MAX_ANGLE) angle = SERVO_MAX_ANGLE;
+
+    MotionProfile jump;
+    jump.plan(angle, angle, limits);
+    const uint32_t modelledUs = (uint32_t)(fabsf(angle - currentAngle()) / SERVO_RATED_SPEED * 1e6f);
+    targetAngle = angle;
+    publish(jump, modelledUs, (uint32_t)microseconds * 16);
 }
 
 void ServoControl::detach() {
     if (channel >= 0) {
-        ledcDetachPin(pin);
+        hal::timer::stop(updateTimer);
+        updating = false;
+        feedback.pause();
+        hal::pwm::detach(pin);
         channel = -1;
+        lastDuty.store(-1, std::memory_order_relaxed);
     }
 }
 
-void ServoControl::setPulseWidthRange(int minUs, int maxUs) {
-    minPulseWidth = minUs;
-    maxPulseWidth = maxUs;
+//* ************************************************************************
+//* ************************* POSITION MODEL ******************************
+//* ************************************************************************
+float ServoControl::currentAngle() const {
+    return move.profile.angleAt(hal::Clock::micros() - move.startUs);
 }
 
-void ServoControl::setAngleRange(int minDeg, int maxDeg) {
-    minAngle = minDeg;
-    maxAngle = maxDeg;
-} 
+bool ServoControl::isMoving() const {
+    return hal::Clock::micros() - move.startUs < move.profile.durationUs();
+}
+
+// Raw pulses have no angle to arrive at, and a feedback signal that is out
+// of range can't be trusted: both fall back to the model
+bool ServoControl::readFeedback(ServoFeedback::Reading& reading) const {
+    if (!feedback.fitted() || move.rawPulseQ4 != 0) return false;
+    reading = feedback.read();
+    return reading.valid;
+}
+
+float ServoControl::measuredAngle() const {
+    ServoFeedback::Reading reading;
+    return readFeedback(reading) ? reading.angle : currentAngle();
+}
+
+bool ServoControl::measuringArrival() const {
+    ServoFeedback::Reading reading;
+    return readFeedback(reading);
+}
+
+bool ServoControl::hasReachedTarget() const {
+    ServoFeedback::Reading reading;
+    if (readFeedback(reading)) {
+        // In the band and nearly still, for the settle time
+        return reading.move == moveId && reading.settled && hal::Clock::micros() - reading.settledSinceUs >= settleUs;
+    }
+    // Modelled move time plus a short mechanical settle allowance
+    return hal::Clock::micros() - move.startUs >= arrivalUs + settleUs;
+}
 
-bool ServoControl::hasReachedTarget() {
-    // Check if enough time has passed since the last write() command
-    return millis() - lastUpdateTime >= SERVO_MOVE_DELAY;
-} 
\ No newline at end of file
+uint32_t ServoControl::moveTimeUs() const {
+    ServoFeedback::Reading reading;
+    if (readFeedback(reading) && reading.move == moveId && reading.settled) {
+        return reading.settledSinceUs - move.startUs;
+    }
+    return arrivalUs;
+}
@@ -0,0 +1,92 @@
+#include "ServoFeedback.h"
+#include <math.h>
+#include "config/Config.h"
+
+static_assert(SERVO_FEEDBACK_MAX_MV > SERVO_FEEDBACK_MIN_MV, "Servo feedback voltage span is empty");
+
+static const float DEG_PER_MV = (float)(SERVO_MAX_ANGLE - SERVO_MIN_ANGLE) / (SERVO_FEEDBACK_MAX_MV - SERVO_FEEDBACK_MIN_MV);
+
+ServoFeedback::ServoFeedback() {
+    pin = -1;
+    sampleTimer = hal::timer::Handle();
+    sampling = false;
+    current = { 0, NAN, 0.0f };
+    state = {};
+    lastSampleUs = 0;
+}
+
+void ServoFeedback::begin(int adcPin) {
+    pin = adcPin;
+    if (pin < 0) return;
+    hal::adc::setup(pin);
+
+    current = { 0, NAN, 0.0f };
+    state = {};
+    target.write(current);
+    published.write(state);
+    sampleTimer = hal::timer::create(timerCallback, this, "servo fb");
+    sampling = false;
+    resume();
+}
+
+void ServoFeedback::track(uint32_t move, float targetAngle, float tolerance) {
+    target.write({ move, targetAngle, tolerance });
+}
+
+void ServoFeedback::pause() {
+    if (!sampling) return;
+    hal::timer::stop(sampleTimer);
+    sampling = false;
+}
+
+void ServoFeedback::resume() {
+    if (sampling || pin < 0) return;
+    hal::timer::start(sampleTimer, 1000000UL / SERVO_FEEDBACK_SAMPLE_HZ);
+    sampling = true;
+}
+
+void ServoFeedback::timerCallback(void* arg) {
+    static_cast<ServoFeedback*>(arg)->sample();
+}
+
+void ServoFeedback::sample() {
+    uint32_t sumMv = 0;
+    for (int i = 0; i < SERVO_FEEDBACK_OVERSAMPLE; i++) sumMv += hal::adc::readMilliVolts(pin);
+    const float mv = (float)sumMv / SERVO_FEEDBACK_OVERSAMPLE;
+    const uint32_t nowUs = hal::Clock::micros();
+
+    Target latest;
+    if (target.tryRead(latest)) current = latest;   // Mid-publish: keep last frame's target
+    if (current.move != state.move) {
+        state.move = current.move;
+        state.settled = false;
+    }
+
+    // A disconnected wiper reads near a rail: say so rather than report an angle
+    if (mv < SERVO_FEEDBACK_MIN_MV - SERVO_FEEDBACK_MARGIN_MV || mv > SERVO_FEEDBACK_MAX_MV + SERVO_FEEDBACK_MARGIN_MV) {
+        state.valid = false;
+        state.settled = false;
+        published.write(state);
+        return;
+    }
+
+    // First-order low-pass on the angle, and on the speed derived from it
+    const float angle = SERVO_MIN_ANGLE + (mv - SERVO_FEEDBACK_MIN_MV) * DEG_PER_MV;
+    const float dt = (nowUs - lastSampleUs) * 1e-6f;
+    lastSampleUs = nowUs;
+    if (!state.valid || dt <= 0.0f) {
+        state.angle = angle;
+        state.speed = 0.0f;
+        state.valid = true;
+    } else {
+        const float alpha = dt / (SERVO_FEEDBACK_FILTER_MS * 1e-3f + dt);
+        const float previous = state.angle;
+        state.angle += alpha * (angle - state.angle);
+        state.speed += alpha * (fabsf(state.angle - previous) / dt - state.speed);
+    }
+
+    const bool inBand = fabsf(state.angle - current.angle) <= current.tolerance && state.speed <= SERVO_SETTLED_SPEED;
+    if (inBand && !state.settled) state.settledSinceUs = nowUs;
+    state.settled = inBand;
+    published.write(state);
+}
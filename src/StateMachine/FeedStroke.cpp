@@ -0,0 +1,68 @@
+#include "StateMachine/FeedStroke.h"
+#include "StateMachine/StateMachine.h"
+
+// Move the timeout toward `strokeMs` plus margin: up at once, down gradually
+void FeedStroke::adjustTimeout(float strokeMs, const MachineParams& p) {
+    if (!learning) learnedTimeoutMs = p.feedTime;
+    learning = true;
+
+    float target = strokeMs * (1.0f + p.feedLearnMargin) + p.feedLearnMarginMs;
+    if (target < p.feedMinTime) target = p.feedMinTime;
+    if (target > p.feedTime) target = p.feedTime;
+
+    if (target >= learnedTimeoutMs) learnedTimeoutMs = target;
+    else learnedTimeoutMs -= (learnedTimeoutMs - target) * p.feedLearnRate;
+}
+
+// Fold a sensed stroke time into the history and retune the timeout
+void FeedStroke::learn(uint32_t strokeMs, const MachineParams& p) {
+    history[historyNext] = strokeMs;
+    historyNext = (historyNext + 1) % HISTORY;
+    if (historyCount < HISTORY) historyCount++;
+
+    uint32_t slowest = 0;
+    for (int i = 0; i < historyCount; i++) {
+        if (history[i] > slowest) slowest = history[i];
+    }
+    adjustTimeout((float)slowest, p);
+}
+
+// Learned timeout, kept inside the current parameter limits
+float FeedStroke::currentTimeoutMs(const MachineParams& p) const {
+    if (!learning) return p.feedTime;
+    if (learnedTimeoutMs < p.feedMinTime) return p.feedMinTime;
+    if (learnedTimeoutMs > p.feedTime) return p.feedTime;
+    return learnedTimeoutMs;
+}
+
+void FeedStroke::begin() {
+    strokeStartUs = hal::Clock::micros();
+}
+
+bool FeedStroke::complete(Lane& lane) {
+    // Switch closed after this stroke began: done, at the switch's timestamp
+    const InputState& endOfStroke = lane.io.endOfStroke;
+    if (endOfStroke.read() && endOfStroke.edgeTimeUs() - strokeStartUs < 0x80000000UL) {
+        lastSensedMs = (endOfStroke.edgeTimeUs() - strokeStartUs) / 1000;
+        learn(lastSensedMs, lane.params);
+        SM_LOG_ARGS(lane, EV_FEED_STROKE_SENSED, lastSensedMs, (int32_t)currentTimeoutMs(lane.params));
+        return true;
+    }
+
+    const uint32_t elapsedMs = (hal::Clock::micros() - strokeStartUs) / 1000;
+    if (elapsedMs >= currentTimeoutMs(lane.params)) {
+        if (lane.io.hasEndOfStroke) {
+            // The switch is fitted but the cylinder never got there: jammed
+            missed++;
+            LOG_WARN(EV_FEED_STROKE_MISSED, lane.id, lane.state, lane.stepNumber, elapsedMs, missed);
+            raiseFault(lane, FAULT_FEED_JAM, elapsedMs);
+        }
+        // No switch: a timed stroke, and this is its normal end
+        return true;
+    }
+    return false;
+}
+
+uint32_t FeedStroke::timeoutMs(const MachineParams& p) const {
+    return (uint32_t)currentTimeoutMs(p);
+}
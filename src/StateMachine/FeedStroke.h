@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+#include "config/Params.h"
+
+struct Lane;
+
+// ************************************************************************
+// ************************* FEED STROKE COMPLETION ***********************
+// ************************************************************************
+// Closed-loop end of a feed: the stroke is complete when the end-of-stroke
+// switch closes after the cylinder was driven, or when the adaptive timeout
+// runs out. The timeout starts at FEED_TIME and is learned from the slowest
+// of the recent sensed strokes plus a safety margin; it grows immediately
+// when a stroke is slower, and shrinks gradually (FEED_LEARN_RATE) when
+// strokes are faster. Each lane learns its own cylinder. With the switch
+// fitted, running into the timeout means the stroke jammed and faults the
+// lane. Without it nothing is measured, so nothing is learned: every stroke
+// simply runs for FEED_TIME. The step watchdog still bounds the step at
+// FEED_TIME plus its margin either way.
+
+class FeedStroke {
+public:
+    static const int HISTORY = 8;  // Recent sensed strokes the timeout is learned from
+
+    void begin();                        // Call right after driving the cylinder
+    bool complete(Lane& lane);           // Poll each tick while the feed is active
+
+    uint32_t timeoutMs(const MachineParams& p) const;   // Current effective timeout
+    uint32_t lastStrokeMs() const { return lastSensedMs; }   // Last sensed stroke time (0 if none yet)
+    uint32_t missedCount() const { return missed; }          // Strokes that ended on the timeout
+
+private:
+    uint32_t strokeStartUs = 0;
+    float learnedTimeoutMs = 0.0f;     // Meaningful while `learning`
+    bool learning = false;             // A stroke has been sensed
+    uint32_t history[HISTORY] = {};
+    int historyCount = 0;
+    int historyNext = 0;
+    uint32_t lastSensedMs = 0;
+    uint32_t missed = 0;
+
+    void learn(uint32_t strokeMs, const MachineParams& p);
+    void adjustTimeout(float strokeMs, const MachineParams& p);
+    float currentTimeoutMs(const MachineParams& p) const;
+};
@@ -0,0 +1,39 @@
+#include "StateMachine/OverlapScheduler.h"
+#include "StateMachine/StateMachine.h"
+
+namespace Overlap {
+
+float cylinderReturnProgress(const MachineParams& p, uint32_t sinceReleaseMs) {
+    if (p.cylinderReturnTime <= 0.0f || sinceReleaseMs >= p.cylinderReturnTime) return 1.0f;
+    return sinceReleaseMs / p.cylinderReturnTime;
+}
+
+bool flipMayStart(const Lane& lane, uint32_t sinceReleaseMs) {
+    // Interlock: never swing the arm while the cylinder is still driven
+    if (lane.io.feedCylinder) return false;
+    return cylinderReturnProgress(lane.params, sinceReleaseMs) >= lane.params.flipStartReturnFraction;
+}
+
+bool servoPastSafeAngle(const Lane& lane) {
+    const MachineParams& p = lane.params;
+    const ServoControl& servo = lane.flipServo;
+
+    // Interlock: only meaningful while the arm is actually heading home
+    if (servo.targetAngle != p.servoHomeAngle) return false;
+
+    // A safe angle outside the flip..home span can't be trusted
+    const bool homeAbove = p.servoHomeAngle > p.flipAngle;
+    const float low = homeAbove ? p.flipAngle : p.servoHomeAngle;
+    const float high = homeAbove ? p.servoHomeAngle : p.flipAngle;
+    if (p.feed2SafeReturnAngle < low || p.feed2SafeReturnAngle > high) return false;
+
+    const float angle = servo.measuredAngle();
+    return homeAbove ? angle >= p.feed2SafeReturnAngle : angle <= p.feed2SafeReturnAngle;
+}
+
+bool feed2MayStart(const Lane& lane, uint32_t sinceReturnStartMs) {
+    if (sinceReturnStartMs < lane.params.feedingStartDelay2) return false;
+    return lane.flipServo.hasReachedTarget() || servoPastSafeAngle(lane);
+}
+
+} // namespace Overlap
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include "config/Params.h"
+
+struct Lane;
+
+// ************************************************************************
+// *********************** PHASE OVERLAP SCHEDULER ************************
+// ************************************************************************
+// Decides when the next phase of the cycle may start before the previous
+// one has fully finished. Thresholds come from the lane's parameters; the
+// interlocks in here hold regardless of how aggressively those thresholds
+// are set.
+
+namespace Overlap {
+
+// How far the cylinder's return stroke has progressed (0..1), from the
+// time since it was released and the modelled CYLINDER_RETURN_TIME
+float cylinderReturnProgress(const MachineParams& p, uint32_t sinceReleaseMs);
+
+// Flip may start: cylinder released and far enough into its return stroke
+bool flipMayStart(const Lane& lane, uint32_t sinceReleaseMs);
+
+// Second feed may start: FEEDING_START_DELAY_2 has passed since the servo
+// began returning, and the arm is home or already past the safe angle
+bool feed2MayStart(const Lane& lane, uint32_t sinceReturnStartMs);
+
+// True if the returning arm is between FEED2_SAFE_RETURN_ANGLE and home
+// (measured with a feedback servo, modelled otherwise)
+bool servoPastSafeAngle(const Lane& lane);
+
+} // namespace Overlap
@@ -0,0 +1,59 @@
+#include "StateMachine/StepTable.h"
+
+// ************************************************************************
+// ************************ IDLE STATE ************************************
+// ************************************************************************
+
+namespace IdleSteps {
+
+//! ************************************************************************
+//! ENSURE SERVO IS IN HOME POSITION
+//! ************************************************************************
+void enterWait(Lane& lane) {
+    lane.flipServo.write(lane.params.servoHomeAngle);
+    lane.levelStartArmed = true;
+}
+
+// A part can be on the sensor with no edge left to latch: it arrived
+// during a fault or a hold, behind the previous part without a gap, or its
+// edge was coalesced. Once per entry to IDLE, with nothing queued, an
+// active start sensor counts as a start.
+static void latchSensorLevel(Lane& lane) {
+    if (!lane.levelStartArmed || lane.triggers.pending()) return;
+    lane.levelStartArmed = false;
+    if (!lane.io.startSensor.read()) return;
+    lane.triggers.requeue({ TRIGGER_SENSOR, false, hal::Clock::micros() });
+    SM_LOG(lane, EV_TRIGGER_LEVEL);
+}
+
+//! ************************************************************************
+//! APPLY STAGED PARAMETERS, WAIT FOR A LATCHED START TRIGGER
+//! ************************************************************************
+bool startRequested(Lane& lane) {
+    // Cycle boundary: take staged parameter changes before the next cycle
+    if (Params::applyPending(lane.id, lane.params)) {
+        SM_LOG(lane, EV_PARAMS_APPLIED);
+        lane.watchdog.reset();   // Step times learned under the old values no longer apply
+        applyServoParams(lane);
+        lane.flipServo.write(lane.params.servoHomeAngle);
+    }
+
+    // Don't start a new cycle while held (e.g. OTA in progress)
+    if (holdRequested()) return false;
+    latchSensorLevel(lane);
+    return lane.triggers.pending();
+}
+
+void acceptStart(Lane& lane) {
+    SM_LOG(lane, EV_START_SIGNAL);
+    Trigger trigger;
+    lane.triggers.pop(trigger);
+    lane.levelStartArmed = false;   // This cycle is for the part on the sensor
+
+    // Only an edge seen while waiting in IDLE measures start latency; one
+    // that waited for the previous cycle to finish does not
+    const bool waitedInIdle = trigger.edgeUs - lane.stateStartUs < 0x80000000UL;
+    markStartTrigger(lane, trigger.source, trigger.fresh && waitedInIdle, trigger.edgeUs);
+}
+
+} // namespace IdleSteps
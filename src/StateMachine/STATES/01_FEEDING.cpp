@@ -0,0 +1,37 @@
+#include "StateMachine/StepTable.h"
+
+// ************************************************************************
+// *********************** FEEDING STATE **********************************
+// ************************************************************************
+
+namespace FeedingSteps {
+
+//! ************************************************************************
+//! STEP 1: WAIT FOR START DELAY AND RETRACT CYLINDER
+//! ************************************************************************
+bool startDelayDone(Lane& lane) {
+    return stateElapsedMs(lane) >= lane.params.feedingStartDelay1;
+}
+
+void beginStroke(Lane& lane) {
+    SM_LOG(lane, EV_FEED1_DELAY_DONE);
+    // Retract cylinder to push wood
+    writeFeedCylinder(lane, HIGH);
+    lane.feedStroke.begin();
+    markCylinderActuated(lane);
+}
+
+//! ************************************************************************
+//! STEP 2: WAIT FOR THE STROKE TO COMPLETE (SWITCH OR TIMEOUT)
+//! ************************************************************************
+bool strokeComplete(Lane& lane) {
+    return lane.feedStroke.complete(lane);
+}
+
+void endStroke(Lane& lane) {
+    SM_LOG(lane, EV_FEED1_DONE);
+    // Extend cylinder to safe position
+    writeFeedCylinder(lane, LOW);
+}
+
+} // namespace FeedingSteps
@@ -0,0 +1,58 @@
+#include "StateMachine/StepTable.h"
+#include "StateMachine/OverlapScheduler.h"
+
+// ************************************************************************
+// *********************** FLIPPING STATE *********************************
+// ************************************************************************
+
+namespace FlippingSteps {
+
+//! ************************************************************************
+//! STEP 1: MOVE SERVO TO FLIP POSITION
+//! ************************************************************************
+bool flipMayStart(Lane& lane) {
+    // Start once the cylinder is far enough into its return stroke
+    return Overlap::flipMayStart(lane, stateElapsedMs(lane));
+}
+
+void moveOut(Lane& lane) {
+    lane.flipServo.moveTo(lane.params.flipAngle);
+}
+
+//! ************************************************************************
+//! STEP 2: WAIT FOR SERVO TO FINISH MOVING
+//! ************************************************************************
+bool servoArrived(Lane& lane) {
+    return lane.flipServo.hasReachedTarget();
+}
+
+void reachedOut(Lane& lane) {
+    const uint32_t moveUs = lane.flipServo.moveTimeUs();
+    lane.flipMoveUs.record(moveUs);
+    SM_LOG_ARGS(lane, EV_FLIP_REACHED_OUT, moveUs / 1000, (int32_t)(lane.flipServo.measuredAngle() * 10.0f));
+}
+
+//! ************************************************************************
+//! STEP 3: MOVE SERVO BACK TO HOME POSITION
+//! ************************************************************************
+void moveHome(Lane& lane) {
+    lane.flipServo.moveTo(lane.params.servoHomeAngle);
+    lane.returnStartUs = hal::Clock::micros();
+}
+
+//! ************************************************************************
+//! STEP 4: WAIT FOR SERVO TO RETURN HOME (OR PAST THE SAFE ANGLE)
+//! ************************************************************************
+bool feed2MayStart(Lane& lane) {
+    return Overlap::feed2MayStart(lane, (hal::Clock::micros() - lane.returnStartUs) / 1000);
+}
+
+void leaveFlip(Lane& lane) {
+    if (lane.flipServo.hasReachedTarget()) {
+        SM_LOG(lane, EV_FLIP_REACHED_HOME);
+    } else {
+        SM_LOG_ARGS(lane, EV_FLIP_OVERLAP_FEED2, (int32_t)(lane.flipServo.measuredAngle() * 10.0f), 0);
+    }
+}
+
+} // namespace FlippingSteps
@@ -0,0 +1,31 @@
+#include "StateMachine/StepTable.h"
+
+// ************************************************************************
+// ********************* SECOND FEEDING STATE *****************************
+// ************************************************************************
+
+namespace Feeding2Steps {
+
+//! ************************************************************************
+//! STEP 1: START SECOND FEED
+//! ************************************************************************
+void beginStroke(Lane& lane) {
+    // Retract cylinder to push wood
+    writeFeedCylinder(lane, HIGH);
+    lane.feedStroke.begin();
+}
+
+//! ************************************************************************
+//! STEP 2: WAIT FOR THE STROKE TO COMPLETE (SWITCH OR TIMEOUT)
+//! ************************************************************************
+bool strokeComplete(Lane& lane) {
+    return lane.feedStroke.complete(lane);
+}
+
+void endStroke(Lane& lane) {
+    SM_LOG(lane, EV_FEED2_DONE);
+    // Extend cylinder to safe position
+    writeFeedCylinder(lane, LOW);
+}
+
+} // namespace Feeding2Steps
@@ -0,0 +1,68 @@
+#include "StateMachine/StepTable.h"
+
+// ************************************************************************
+// ************************* FAULT STATE **********************************
+// ************************************************************************
+
+namespace FaultSteps {
+
+static bool retriesLeft(const Lane& lane) {
+    return lane.faultRetries < (uint8_t)lane.params.faultRetries;
+}
+
+// Retry n waits n x FAULT_RETRY_DELAY_MS
+static uint32_t retryDelayMs(const Lane& lane) {
+    return (uint32_t)(lane.params.faultRetryDelay * (lane.faultRetries + 1));
+}
+
+//! ************************************************************************
+//! SAFE OUTPUTS: CYLINDER RELEASED, SERVO HOME
+//! ************************************************************************
+void makeSafe(Lane& lane) {
+    writeFeedCylinder(lane, LOW);
+    lane.flipServo.moveTo(lane.params.servoHomeAngle);
+
+    takeFaultClear(lane);   // Only an acknowledgement of this fault counts
+    lane.faultClearing = false;
+    if (retriesLeft(lane)) {
+        SM_LOG_ARGS(lane, EV_FAULT_RETRY_WAIT, lane.faultRetries + 1, retryDelayMs(lane));
+    } else {
+        SM_LOG_ARGS(lane, EV_FAULT_LATCHED, lane.faultRetries, 0);
+    }
+}
+
+//! ************************************************************************
+//! WAIT FOR THE RETRY DELAY, OR FOR AN OPERATOR
+//! ************************************************************************
+bool recoveryDue(Lane& lane) {
+    // Manual start or the "clear" command acknowledges the fault
+    if (lane.io.manualStart.rose() || takeFaultClear(lane)) {
+        lane.faultClearing = true;
+        return true;
+    }
+    if (holdRequested()) return false;
+    return retriesLeft(lane) && stepElapsedMs(lane) >= retryDelayMs(lane);
+}
+
+void recover(Lane& lane) {
+    if (lane.faultClearing) {
+        // Back to IDLE; a manual start press is also a queued start
+        lane.faultRetries = 0;
+        SM_LOG(lane, EV_FAULT_CLEARED);
+    } else {
+        // The part is still in the machine: run its cycle again
+        lane.faultRetries++;
+        lane.triggers.requeue({ TRIGGER_RETRY, false, hal::Clock::micros() });
+        SM_LOG_ARGS(lane, EV_FAULT_RETRY, lane.faultRetries, 0);
+    }
+    lane.faultCause = FAULT_NONE;
+}
+
+// Held retries wait for the hold to lift, which wakes the control task
+uint32_t retryDueMs(const Lane& lane) {
+    if (!retriesLeft(lane) || holdRequested()) return LANE_REST_FOREVER;
+    const uint32_t elapsedMs = stepElapsedMs(lane);
+    return elapsedMs < retryDelayMs(lane) ? retryDelayMs(lane) - elapsedMs : 0;
+}
+
+} // namespace FaultSteps
@@ -0,0 +1,368 @@
+#include "StateMachine/StateMachine.h"
+#include "StateMachine/StepTable.h"
+#include "Seqlock.h"
+#include "Telemetry.h"
+#include "TraceRing.h"
+#include <string.h>
+#include <atomic>
+#include <tuple>
+#include <utility>
+
+// ************************************************************************
+// ********************** GLOBAL VARIABLES ********************************
+// ************************************************************************
+
+// Each lane's debounced inputs and cylinder output, bound to its pins at
+// compile time (config/Hardware.h): std::tuple<LaneHardware<0>, ...>.
+// with() runs `action` on the one lane's hardware as its own type: one
+// compare per lane, all inlined, then direct register access.
+template <typename Seq> struct LaneHardwareSet;
+template <size_t... I> struct LaneHardwareSet<std::index_sequence<I...>> {
+    std::tuple<LaneHardware<I>...> lanes;
+
+    template <typename Action>
+    void with(size_t lane, Action&& action) {
+        ((lane == I ? action(std::get<I>(lanes)) : void()), ...);
+    }
+};
+
+static LaneHardwareSet<std::make_index_sequence<LANE_COUNT>> laneHardware;
+
+Lane lanes[LANE_COUNT];
+
+static const char* const STATE_NAMES[S_COUNT] = { "NONE", "IDLE", "FEEDING", "FLIPPING", "FEEDING2", "FAULT" };
+
+static_assert(ST_COUNT <= TELEMETRY_MAX_STEPS, "Telemetry records have no room for every step");
+
+// Set from the network task, read by the control task
+static std::atomic<uint8_t> holdOwners(0);   // HoldOwner bits
+static std::atomic<bool> faultClearFlags[LANE_COUNT];
+static Seqlock<LaneStatsSnapshot> laneStats[LANE_COUNT];
+
+ControlWakeHook controlWakeHook = nullptr;
+
+// ************************************************************************
+// ********************** HELPER FUNCTIONS ********************************
+// ************************************************************************
+// Called by IDLE when it accepts a start; edgeUs is only meaningful for a
+// fresh edge that arrived while the lane was waiting in IDLE
+void markStartTrigger(Lane& lane, TelemetryTrigger source, bool freshEdge, uint32_t edgeUs) {
+    lane.cycleRecord.trigger = source;
+    lane.triggerFresh = freshEdge;
+    lane.triggerEdgeUs = edgeUs;
+    lane.triggerDetectUs = hal::Clock::micros() - edgeUs;
+}
+
+// Called right after the feed cylinder is driven high in FEEDING
+void markCylinderActuated(Lane& lane) {
+    if (!lane.triggerFresh) return;
+    lane.triggerFresh = false;
+
+    const uint32_t sinceEdgeUs = hal::Clock::micros() - lane.triggerEdgeUs;
+    const uint32_t delayUs = (uint32_t)(lane.params.feedingStartDelay1 * 1000.0f);
+    const uint32_t actuateUs = sinceEdgeUs > delayUs ? sinceEdgeUs - delayUs : 0;
+
+    StartLatency& latency = lane.startLatency;
+    latency.samples++;
+    latency.lastDetectUs = lane.triggerDetectUs;
+    latency.lastActuateUs = actuateUs;
+    if (lane.triggerDetectUs > latency.maxDetectUs) latency.maxDetectUs = lane.triggerDetectUs;
+    if (actuateUs > latency.maxActuateUs) latency.maxActuateUs = actuateUs;
+    lane.cycleRecord.startLatencyUs = actuateUs;
+    SM_LOG_ARGS(lane, EV_START_LATENCY, lane.triggerDetectUs, actuateUs);
+}
+
+void requestHold(HoldOwner owner, bool hold) {
+    if (hold) holdOwners.fetch_or(owner, std::memory_order_acq_rel);
+    else holdOwners.fetch_and((uint8_t)~owner, std::memory_order_acq_rel);
+    wakeControl();
+}
+
+bool holdRequested() {
+    return holdOwners.load(std::memory_order_acquire) != 0;
+}
+
+bool allLanesIdle() {
+    for (const Lane& lane : lanes) {
+        if (lane.state != S_IDLE) return false;
+    }
+    return true;
+}
+
+bool allLanesStopped() {
+    for (const Lane& lane : lanes) {
+        if (lane.state != S_IDLE && lane.state != S_FAULT) return false;
+    }
+    return true;
+}
+
+// At rest: waiting in IDLE with nothing queued and the arm home, or
+// holding a fault. Debounce lockouts are covered by the control task only
+// sleeping once every lane has been at rest for IDLE_SETTLE_MS.
+uint32_t laneRestMs(const Lane& lane) {
+    if (!lane.flipServo.hasReachedTarget()) return 0;
+    switch (lane.step) {
+    case ST_IDLE_WAIT_START:
+        if (lane.levelStartArmed && !holdRequested()) return 0;
+        return lane.triggers.pending() || Params::pending(lane.id) ? 0 : LANE_REST_FOREVER;
+    case ST_FAULT_HOLD:
+        return FaultSteps::retryDueMs(lane);
+    default:
+        return 0;
+    }
+}
+
+void wakeControl() {
+    if (controlWakeHook) controlWakeHook();
+}
+
+void raiseFault(Lane& lane, FaultCause cause, int32_t arg0, int32_t arg1) {
+    if (lane.faultCause != FAULT_NONE) return;
+    lane.faultCause = cause;
+    const LogEvent event = cause == FAULT_FEED_JAM ? EV_FAULT_FEED_JAM : EV_FAULT_WATCHDOG;
+    LOG_ERROR(event, lane.id, lane.state, lane.stepNumber, arg0, arg1);
+}
+
+void requestFaultClear(int lane) {
+    if (lane >= 0 && lane < LANE_COUNT) faultClearFlags[lane].store(true, std::memory_order_release);
+    wakeControl();
+}
+
+bool takeFaultClear(Lane& lane) {
+    return faultClearFlags[lane.id].exchange(false, std::memory_order_acq_rel);
+}
+
+const StepDef& stepDef(StepId step) {
+    return STEP_TABLE[step];
+}
+
+const char* stateName(State state) {
+    return state < S_COUNT ? STATE_NAMES[state] : "?";
+}
+
+// ************************************************************************
+// ************************** STEP DISPATCH *******************************
+// ************************************************************************
+// Enter a step: cache its tags, log it and run its entry action
+static void beginStep(Lane& lane, StepId next, uint32_t nowUs) {
+    const StepDef& def = STEP_TABLE[next];
+    lane.step = next;
+    lane.state = def.state;
+    lane.stepNumber = def.number;
+    lane.stepStartUs = nowUs;
+    lane.stepStats[next].entries++;
+
+    SM_LOG(lane, def.enterEvent);
+    if (def.onEnter) def.onEnter(lane);
+
+    // Post-mortem trail; outputs as the entry action left them
+    const uint8_t outputs = (lane.io.feedCylinder ? TRACE_OUT_CYLINDER : 0) |
+                            (lane.flipServo.isMoving() ? TRACE_OUT_SERVO_MOVING : 0);
+    TraceRing::record({ hal::Clock::millis(), lane.id, (uint8_t)next, outputs, (uint8_t)lane.faultCause,
+                        (int16_t)(lane.flipServo.targetAngle * 10.0f), (uint16_t)(lane.cycleSequence + 1) });
+}
+
+// Leaving IDLE: start a fresh record (the trigger is set by IDLE's exit action,
+// which has already run)
+static void beginCycleRecord(Lane& lane, uint32_t nowUs) {
+    const uint8_t trigger = lane.cycleRecord.trigger;
+    lane.cycleRecord = {};
+    lane.cycleRecord.trigger = trigger;
+    lane.cycleRecord.lane = lane.id;
+    lane.cycleStartUs = nowUs;
+}
+
+// Back in IDLE: the cycle is complete
+static void endCycleRecord(Lane& lane, uint32_t nowUs) {
+    const uint32_t cycleUs = nowUs - lane.cycleStartUs;
+    lane.cycleTimeUs.record(cycleUs);
+
+    TelemetryRecord& record = lane.cycleRecord;
+    record.sequence = ++lane.cycleSequence;
+    record.endMs = hal::Clock::millis();
+    record.cycleUs = cycleUs;
+    record.stepCount = ST_COUNT;
+    Telemetry::submit(record);
+    record.trigger = TRIGGER_NONE;
+
+    // A clean cycle ends the run of automatic retries
+    if (!(record.flags & TELEMETRY_FLAG_FAULT)) lane.faultRetries = 0;
+}
+
+// Control task -> readers, copied straight into the seqlock's buffer
+static void publishLaneStats(const Lane& lane) {
+    laneStats[lane.id].writeWith([&lane](LaneStatsSnapshot& s) {
+        s.state = lane.state;
+        memcpy(s.stepStats, lane.stepStats, sizeof(s.stepStats));
+        memcpy(s.stateDurationUs, lane.stateDurationUs, sizeof(s.stateDurationUs));
+        s.cycleTimeUs = lane.cycleTimeUs;
+        s.flipMoveUs = lane.flipMoveUs;
+        s.flipMoveMeasured = lane.flipServo.measuringArrival();
+        s.faults = lane.faults;
+        s.faultRetries = lane.faultRetries;
+        s.triggersLatched = lane.triggers.latchedCount();
+        s.triggersCoalesced = lane.triggers.coalescedCount();
+        s.triggersDropped = lane.triggers.droppedCount();
+        s.triggersQueued = lane.triggers.queued();
+    });
+}
+
+void readLaneStats(int lane, LaneStatsSnapshot& out) {
+    while (!laneStats[lane].tryRead(out)) {}
+}
+
+// Close out the current step's statistics and enter the next one
+static void enterStep(Lane& lane, StepId next, uint32_t nowUs) {
+    const State stateBefore = lane.state;
+    StepStats& stats = lane.stepStats[lane.step];
+    const uint32_t durationUs = nowUs - lane.stepStartUs;
+    stats.lastUs = durationUs;
+    stats.durationUs.record(durationUs);
+    lane.cycleRecord.stepUs[lane.step] += durationUs;
+
+    const StepDef& def = STEP_TABLE[next];
+    if (def.state != lane.state) {
+        lane.stateDurationUs[lane.state].record(nowUs - lane.stateStartUs);
+        lane.stateStartUs = nowUs;
+
+        // A cycle runs from leaving IDLE until IDLE is entered again
+        if (lane.state == S_IDLE) beginCycleRecord(lane, nowUs);
+        else if (def.state == S_IDLE) endCycleRecord(lane, nowUs);
+    }
+    beginStep(lane, next, nowUs);
+
+    // Cycle boundaries and faults are state changes: the stats a reader
+    // sees are whole, at the cost of lagging by up to one state
+    if (def.state != stateBefore) publishLaneStats(lane);
+}
+
+// ************************************************************************
+// ********************** HARDWARE INITIALIZATION *************************
+// ************************************************************************
+static void initLane(Lane& lane, uint8_t id) {
+    lane.id = id;
+    lane.params = Params::active(id);
+
+    // Set up the pins and debouncers
+    laneHardware.with(id, [&lane](auto& hw) { hw.begin(lane.io); });
+
+    // Make sure cylinder starts in safe position (retracted)
+    writeFeedCylinder(lane, LOW); // LOW = extended = safe
+
+    // Configure servo motor and move to home position
+    const LanePins& pins = LANE_PINS[id];
+    lane.flipServo.init(pins.flipServo, pins.servoChannel, SERVO_PWM_FREQ, SERVO_PWM_RESOLUTION);
+    lane.flipServo.setLogLane(id);
+    if (pins.servoFeedback >= 0) lane.flipServo.attachFeedback(pins.servoFeedback);
+    applyServoParams(lane);
+    lane.flipServo.write(lane.params.servoHomeAngle);
+
+    // Start the cycle table at IDLE
+    lane.state = S_NONE;
+    lane.stepNumber = 0;
+    lane.returnStartUs = 0;
+    lane.cycleRecord = {};
+    lane.triggerFresh = false;
+    lane.triggers.clear();
+    lane.levelStartArmed = false;
+    lane.feedStroke = FeedStroke();   // Nothing learned carries over a re-init (simulator runs)
+    lane.watchdog.reset();
+    lane.faultCause = FAULT_NONE;
+    lane.faultRetries = 0;
+    lane.faultClearing = false;
+
+    // A part already on the sensor at power-on has no edge; start it anyway
+    const uint32_t nowUs = hal::Clock::micros();
+    if (lane.io.startSensor.read()) lane.triggers.latch({ TRIGGER_SENSOR, false, nowUs }, lane.params);
+    else if (lane.io.manualStart.read()) lane.triggers.latch({ TRIGGER_MANUAL, false, nowUs }, lane.params);
+
+    lane.stateStartUs = hal::Clock::micros();
+    lane.step = ST_IDLE_WAIT_START;
+    beginStep(lane, ST_IDLE_WAIT_START, lane.stateStartUs);
+    publishLaneStats(lane);
+}
+
+void initStateMachine() {
+    for (uint8_t i = 0; i < LANE_COUNT; i++) initLane(lanes[i], i);
+}
+
+// ************************************************************************
+// ************************** INPUT UPDATE ********************************
+// ************************************************************************
+// Latch a start edge into the lane's trigger queue, in any state
+static void latchTrigger(Lane& lane, TelemetryTrigger source, const InputState& input) {
+    if (!input.rose()) return;
+
+    TriggerQueue& triggers = lane.triggers;
+    const uint32_t dropped = triggers.droppedCount();
+    if (triggers.latch({ source, true, input.edgeTimeUs() }, lane.params)) {
+        if (lane.state != S_IDLE) SM_LOG_ARGS(lane, EV_TRIGGER_QUEUED, triggers.queued(), 0);
+    } else if (triggers.droppedCount() != dropped) {
+        LOG_WARN(EV_TRIGGER_DROPPED, lane.id, lane.state, lane.stepNumber, triggers.queued(), triggers.droppedCount());
+    } else {
+        LOG_DEBUG(EV_TRIGGER_COALESCED, lane.id, lane.state, lane.stepNumber, 0, 0);
+    }
+}
+
+void updateInputs(Lane& lane) {
+    laneHardware.with(lane.id, [&lane](auto& hw) { hw.update(lane.io); });
+
+    latchTrigger(lane, TRIGGER_SENSOR, lane.io.startSensor);
+    latchTrigger(lane, TRIGGER_MANUAL, lane.io.manualStart);
+}
+
+void writeFeedCylinder(Lane& lane, bool high) {
+    laneHardware.with(lane.id, [&lane, high](auto& hw) { hw.writeFeedCylinder(lane.io, high); });
+}
+
+// ************************************************************************
+// ********************** STATE MACHINE HANDLER ***************************
+// ************************************************************************
+// The step's guard has passed: run its exit action and move on
+static void leaveStep(Lane& lane, const StepDef& def) {
+    const uint32_t nowUs = hal::Clock::micros();
+    if (def.timeoutMs) lane.watchdog.record(lane.step, nowUs - lane.stepStartUs);
+    if (def.onExit) def.onExit(lane);
+    enterStep(lane, def.next, nowUs);
+}
+
+// Watched step past its deadline: count it and fault the lane
+static bool watchdogExpired(Lane& lane, const StepDef& def) {
+    if (!def.timeoutMs) return false;
+    const uint32_t deadlineMs = lane.watchdog.deadlineMs(lane.step, def.timeoutMs(lane));
+    if (stepElapsedMs(lane) < deadlineMs) return false;
+
+    lane.stepStats[lane.step].timeouts++;
+    lane.cycleRecord.flags |= TELEMETRY_FLAG_STEP_TIMEOUT;
+    LOG_WARN(EV_STEP_TIMEOUT, lane.id, lane.state, lane.stepNumber, lane.step, deadlineMs);
+    raiseFault(lane, FAULT_WATCHDOG, lane.step, deadlineMs);
+    return true;
+}
+
+// Abandon the current step for FAULT; outputs are made safe on entry
+static void enterFault(Lane& lane) {
+    lane.faults++;
+    lane.cycleRecord.flags |= TELEMETRY_FLAG_FAULT;
+    enterStep(lane, ST_FAULT_HOLD, hal::Clock::micros());
+}
+
+void handleStateMachine(Lane& lane) {
+    const StepDef& def = STEP_TABLE[lane.step];
+
+    const bool advance = !watchdogExpired(lane, def) && def.guard(lane);
+    if (lane.faultCause != FAULT_NONE && lane.state != S_FAULT) {
+        enterFault(lane);
+        return;
+    }
+    if (!advance) return;
+    leaveStep(lane, def);
+
+    // Cycle complete with a trigger already waiting: start the next cycle
+    // now rather than a tick later
+    if (lane.step == ST_IDLE_WAIT_START && lane.triggers.pending()) {
+        const StepDef& idle = STEP_TABLE[ST_IDLE_WAIT_START];
+        if (!idle.guard(lane)) return;
+        SM_LOG(lane, EV_TRIGGER_RESTART);
+        leaveStep(lane, idle);
+    }
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include "ServoControl.h"
+#include "StateMachine/FeedStroke.h"
+#include "StateMachine/TriggerQueue.h"
+#include "StateMachine/StepWatchdog.h"
+#include "config/Hardware.h"
+#include "config/Params.h"
+#include "Logger.h"
+#include "Histogram.h"
+#include "TelemetryProtocol.h"
+
+// ************************************************************************
+// ************************ STATE MACHINE *********************************
+// ************************************************************************
+// Shared by the target build (main.cpp) and the native build (native/),
+// so everything in here must go through the HAL rather than Arduino calls.
+//
+// The machine is a flat list of steps (StepId). Each step is one row of
+// STEP_TABLE (StateMachine/StepTable.h): the state it belongs to, the event
+// logged on entry, an optional entry action, the guard that ends the step,
+// an optional exit action, the next step and a timeout. handleStateMachine()
+// indexes the table by the current step, so dispatch is O(1) per tick.
+//
+// Each station is a Lane with its own position in the table; the control
+// task ticks every lane in turn from the same loop.
+//
+// Steps with a timeout are watched: overrunning the (learned) deadline
+// faults the lane, as does raiseFault() from a step's guard. FAULT makes
+// the outputs safe, then retries or waits for an operator (04_FAULT.cpp).
+
+// Keep track of what the machine is doing
+enum State : uint8_t { S_NONE, S_IDLE, S_FEEDING, S_FLIPPING, S_FEEDING2, S_FAULT, S_COUNT };
+
+// Every step of the cycle, in table order
+enum StepId : uint8_t {
+    ST_IDLE_WAIT_START,
+    ST_FEED1_WAIT_DELAY,
+    ST_FEED1_WAIT_STROKE,
+    ST_FLIP_MOVE_OUT,
+    ST_FLIP_WAIT_OUT,
+    ST_FLIP_MOVE_HOME,
+    ST_FLIP_WAIT_HOME,
+    ST_FEED2_START,
+    ST_FEED2_WAIT_STROKE,
+    ST_FAULT_HOLD,
+    ST_COUNT
+};
+
+static_assert(ST_COUNT <= StepWatchdog::MAX_STEPS, "StepWatchdog has no room for every step");
+
+enum FaultCause : uint8_t { FAULT_NONE, FAULT_WATCHDOG, FAULT_FEED_JAM };
+
+struct Lane;
+
+typedef bool (*StepGuard)(Lane& lane);
+typedef void (*StepAction)(Lane& lane);
+typedef uint32_t (*StepTimeout)(const Lane& lane);
+
+// One row of the transition table
+struct StepDef {
+    StepId id;
+    const char* name;          // For the stats dump
+    State state;
+    uint8_t number;            // Step within the state, as shown in the logs
+    LogEvent enterEvent;       // Logged when the step is entered
+    StepAction onEnter;        // Optional
+    StepGuard guard;           // Step ends the first tick this returns true
+    StepAction onExit;         // Optional, runs before entering the next step
+    StepId next;
+    StepTimeout timeoutMs;     // Watchdog ceiling: fault if the guard hasn't passed by then (nullptr = not watched)
+};
+
+// Per-step instrumentation, updated on every step exit
+struct StepStats {
+    uint32_t entries;
+    uint32_t lastUs;           // Duration of the most recent completed pass
+    uint32_t timeouts;         // Watchdog deadlines missed
+    Histogram durationUs;
+};
+
+const StepDef& stepDef(StepId step);
+const char* stateName(State state);
+
+// Sensor-edge response times (microseconds), for cycles started by a fresh edge
+struct StartLatency {
+    uint32_t samples;
+    uint32_t lastDetectUs;     // Edge -> IDLE accepts the start
+    uint32_t maxDetectUs;
+    uint32_t lastActuateUs;    // Edge -> feed cylinder high, minus FEEDING_START_DELAY_1
+    uint32_t maxActuateUs;
+};
+
+// ************************************************************************
+// ******************************** LANE **********************************
+// ************************************************************************
+// One feed/flip station: its hardware, parameters, position in the cycle
+// and statistics. Every step function gets the lane it is running for, so
+// lanes share the step table and the STATES/ code but nothing else.
+struct Lane {
+    // --- Identity and hardware ---
+    uint8_t id;                // Index in lanes[]; tags logs, telemetry and stats
+    LaneIo io;
+    ServoControl flipServo;
+    MachineParams params;      // Active set; replaced only at the cycle boundary
+
+    // --- Where the lane is and when it got there ---
+    StepId step;
+    State state;               // STEP_TABLE[step].state, cached for log tagging
+    uint8_t stepNumber;        // STEP_TABLE[step].number, cached for log tagging
+    uint32_t stateStartUs;     // Entry into the current state
+    uint32_t stepStartUs;      // Entry into the current step
+
+    // --- Step working state ---
+    TriggerQueue triggers;     // Start edges latched at any time, taken by IDLE
+    bool levelStartArmed;      // IDLE entered: a start sensor already active starts a cycle
+    FeedStroke feedStroke;
+    uint32_t returnStartUs;    // When the servo was sent home (FLIPPING)
+
+    // --- Faults ---
+    StepWatchdog watchdog;
+    FaultCause faultCause;     // Raised / being handled (FAULT_NONE otherwise)
+    uint8_t faultRetries;      // Automatic retries since the last good cycle
+    bool faultClearing;        // Operator cleared the current fault
+    uint32_t faults;           // Since boot
+
+    // --- Instrumentation ---
+    StepStats stepStats[ST_COUNT];
+    Histogram stateDurationUs[S_COUNT];   // Per pass through each state
+    Histogram cycleTimeUs;                // Start accepted -> back in IDLE
+    Histogram flipMoveUs;                 // Flip out: command to arrival (measured with feedback)
+    StartLatency startLatency;
+
+    // --- Cycle in progress, submitted to telemetry when IDLE is re-entered ---
+    TelemetryRecord cycleRecord;
+    uint32_t cycleSequence;
+    uint32_t cycleStartUs;
+    bool triggerFresh;         // Current cycle was started by a fresh edge
+    uint32_t triggerEdgeUs;    // ...at this time
+    uint32_t triggerDetectUs;
+};
+
+extern Lane lanes[LANE_COUNT];
+
+// A lane's statistics as of its last state change, published by the
+// control task for "stats" and other readers on other tasks. Several KB:
+// keep it in static storage, not on a stack.
+struct LaneStatsSnapshot {
+    State state;
+    StepStats stepStats[ST_COUNT];
+    Histogram stateDurationUs[S_COUNT];
+    Histogram cycleTimeUs;
+    Histogram flipMoveUs;
+    bool flipMoveMeasured;     // flipMoveUs comes from servo feedback, not the model
+    uint32_t faults;
+    uint8_t faultRetries;
+    uint32_t triggersLatched;
+    uint32_t triggersCoalesced;
+    uint32_t triggersDropped;
+    int triggersQueued;
+};
+
+// Copy of the lane's latest snapshot; safe from any task
+void readLaneStats(int lane, LaneStatsSnapshot& out);
+
+void initStateMachine();                    // Every lane: pins, servo, safe outputs, IDLE
+void updateInputs(Lane& lane);
+void writeFeedCylinder(Lane& lane, bool high);   // Drive the lane's cylinder output (HIGH = feeding)
+void handleStateMachine(Lane& lane);
+bool allLanesIdle();
+bool allLanesStopped();                     // Every lane idle or faulted (outputs safe)
+
+// How long the control task may leave the lane unticked: 0 while it has
+// anything to do, else until its next timed event (LANE_REST_FOREVER if
+// none). Input edges and the requests below wake the task on their own.
+const uint32_t LANE_REST_FOREVER = 0xFFFFFFFFUL;
+uint32_t laneRestMs(const Lane& lane);
+
+// Wake the control task early from an idle sleep; set by ControlTask on
+// target. Safe to call from any task, but not from an ISR.
+typedef void (*ControlWakeHook)();
+extern ControlWakeHook controlWakeHook;
+void wakeControl();
+void markStartTrigger(Lane& lane, TelemetryTrigger source, bool freshEdge, uint32_t edgeUs);
+void markCylinderActuated(Lane& lane);
+
+// Time spent in the current state / step
+inline uint32_t stateElapsedMs(const Lane& lane) { return (hal::Clock::micros() - lane.stateStartUs) / 1000; }
+inline uint32_t stepElapsedMs(const Lane& lane) { return (hal::Clock::micros() - lane.stepStartUs) / 1000; }
+
+// Push the lane's flip motion limits and settle time to its servo
+inline void applyServoParams(Lane& lane) {
+    lane.flipServo.setMotionLimits({ lane.params.servoMaxVelocity, lane.params.servoMaxAccel, lane.params.servoMaxJerk });
+    lane.flipServo.setSettleTime((uint32_t)(lane.params.servoMoveDelay * 1000.0f));
+    lane.flipServo.setArriveTolerance(lane.params.servoArriveTolerance);
+}
+
+// Fault the lane: takes effect at the end of the current step function.
+// arg0/arg1 are logged with the cause.
+void raiseFault(Lane& lane, FaultCause cause, int32_t arg0 = 0, int32_t arg1 = 0);
+
+// Operator acknowledgement for a lane's fault; safe to call from any task.
+// takeFaultClear() consumes it (control task). Wakes the control task.
+void requestFaultClear(int lane);
+bool takeFaultClear(Lane& lane);
+
+// Hold every lane in IDLE after its current cycle (e.g. during OTA).
+// Each owner sets and releases only its own hold; lanes stay held while
+// any owner holds. Safe to call from any task; wakes the control task.
+enum HoldOwner : uint8_t { HOLD_ARDUINO_OTA = 1 << 0, HOLD_DELTA_OTA = 1 << 1 };
+void requestHold(HoldOwner owner, bool hold);
+bool holdRequested();
+
+// Log an event tagged with the lane and its current state and step
+#define SM_LOG(lane, event) LOG_INFO(event, (lane).id, (lane).state, (lane).stepNumber)
+#define SM_LOG_ARGS(lane, event, arg0, arg1) LOG_INFO(event, (lane).id, (lane).state, (lane).stepNumber, arg0, arg1)
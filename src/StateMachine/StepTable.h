@@ -0,0 +1,84 @@
+#pragma once
+
+#include "StateMachine/StateMachine.h"
+
+// ************************************************************************
+// ************************* STEP TRANSITION TABLE ************************
+// ************************************************************************
+// The whole cycle as data. To add a step: add its StepId (in order), write
+// its guard/actions in the state's file under STATES/, and add one row
+// here. The static_asserts below reject a table that is out of order or
+// points past the end.
+
+// --- STEP FUNCTIONS (STATES/*.cpp) ---
+namespace IdleSteps {
+void enterWait(Lane& lane);
+bool startRequested(Lane& lane);
+void acceptStart(Lane& lane);
+}
+
+namespace FeedingSteps {
+bool startDelayDone(Lane& lane);
+void beginStroke(Lane& lane);
+bool strokeComplete(Lane& lane);
+void endStroke(Lane& lane);
+}
+
+namespace FlippingSteps {
+bool flipMayStart(Lane& lane);
+void moveOut(Lane& lane);
+bool servoArrived(Lane& lane);
+void reachedOut(Lane& lane);
+void moveHome(Lane& lane);
+bool feed2MayStart(Lane& lane);
+void leaveFlip(Lane& lane);
+}
+
+namespace Feeding2Steps {
+void beginStroke(Lane& lane);
+bool strokeComplete(Lane& lane);
+void endStroke(Lane& lane);
+}
+
+namespace FaultSteps {
+void makeSafe(Lane& lane);
+bool recoveryDue(Lane& lane);
+void recover(Lane& lane);
+uint32_t retryDueMs(const Lane& lane);   // Until the next automatic retry (LANE_REST_FOREVER: none left)
+}
+
+// Guard for steps that only run an action and move on next tick
+inline bool always(Lane&) { return true; }
+
+// --- TIMEOUTS (ms) ---
+// Watchdog ceilings. Functions rather than constants so they follow each
+// lane's parameters; the watchdog tightens them to what the lane actually
+// takes once it has seen the step a few times.
+inline uint32_t feedStrokeTimeoutMs(const Lane& lane) { return (uint32_t)lane.params.feedTime + STEP_TIMEOUT_MARGIN_MS; }
+inline uint32_t flipStartTimeoutMs(const Lane& lane) { return (uint32_t)lane.params.cylinderReturnTime + STEP_TIMEOUT_MARGIN_MS; }
+inline uint32_t servoWaitTimeoutMs(const Lane&) { return SERVO_WAIT_TIMEOUT_MS; }
+inline uint32_t flipHomeTimeoutMs(const Lane& lane) { return SERVO_WAIT_TIMEOUT_MS + (uint32_t)lane.params.feedingStartDelay2; }
+
+constexpr StepDef STEP_TABLE[ST_COUNT] = {
+    // id                    name                 state       #  enter event          onEnter                     guard                          onExit                     next                  timeout (ms)
+    { ST_IDLE_WAIT_START,   "IDLE_WAIT_START",   S_IDLE,     1, EV_IDLE_WAITING,     IdleSteps::enterWait,       IdleSteps::startRequested,     IdleSteps::acceptStart,    ST_FEED1_WAIT_DELAY,  nullptr },
+    { ST_FEED1_WAIT_DELAY,  "FEED1_WAIT_DELAY",  S_FEEDING,  1, EV_FEED1_WAIT_DELAY, nullptr,                    FeedingSteps::startDelayDone,  FeedingSteps::beginStroke, ST_FEED1_WAIT_STROKE, nullptr },
+    { ST_FEED1_WAIT_STROKE, "FEED1_WAIT_STROKE", S_FEEDING,  2, EV_FEED1_WAIT_FEED,  nullptr,                    FeedingSteps::strokeComplete,  FeedingSteps::endStroke,   ST_FLIP_MOVE_OUT,     feedStrokeTimeoutMs },
+    { ST_FLIP_MOVE_OUT,     "FLIP_MOVE_OUT",     S_FLIPPING, 1, EV_FLIP_MOVE_OUT,    nullptr,                    FlippingSteps::flipMayStart,   FlippingSteps::moveOut,    ST_FLIP_WAIT_OUT,     flipStartTimeoutMs },
+    { ST_FLIP_WAIT_OUT,     "FLIP_WAIT_OUT",     S_FLIPPING, 2, EV_FLIP_WAIT_OUT,    nullptr,                    FlippingSteps::servoArrived,   FlippingSteps::reachedOut, ST_FLIP_MOVE_HOME,    servoWaitTimeoutMs },
+    { ST_FLIP_MOVE_HOME,    "FLIP_MOVE_HOME",    S_FLIPPING, 3, EV_FLIP_MOVE_HOME,   FlippingSteps::moveHome,    always,                        nullptr,                   ST_FLIP_WAIT_HOME,    nullptr },
+    { ST_FLIP_WAIT_HOME,    "FLIP_WAIT_HOME",    S_FLIPPING, 4, EV_FLIP_WAIT_HOME,   nullptr,                    FlippingSteps::feed2MayStart,  FlippingSteps::leaveFlip,  ST_FEED2_START,       flipHomeTimeoutMs },
+    { ST_FEED2_START,       "FEED2_START",       S_FEEDING2, 1, EV_FEED2_START,      Feeding2Steps::beginStroke, always,                        nullptr,                   ST_FEED2_WAIT_STROKE, nullptr },
+    { ST_FEED2_WAIT_STROKE, "FEED2_WAIT_STROKE", S_FEEDING2, 2, EV_FEED2_WAIT_FEED,  nullptr,                    Feeding2Steps::strokeComplete, Feeding2Steps::endStroke,  ST_IDLE_WAIT_START,   feedStrokeTimeoutMs },
+    { ST_FAULT_HOLD,        "FAULT_HOLD",        S_FAULT,    1, EV_FAULT_SAFE,       FaultSteps::makeSafe,       FaultSteps::recoveryDue,       FaultSteps::recover,       ST_IDLE_WAIT_START,   nullptr },
+};
+
+// Row i must describe step i, lead somewhere valid and have a guard
+constexpr bool stepTableValid() {
+    for (int i = 0; i < ST_COUNT; i++) {
+        if (STEP_TABLE[i].id != i || STEP_TABLE[i].next >= ST_COUNT || STEP_TABLE[i].guard == nullptr) return false;
+    }
+    return true;
+}
+
+static_assert(stepTableValid(), "STEP_TABLE rows must be in StepId order, with a guard and a valid next step");
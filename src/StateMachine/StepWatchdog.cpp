@@ -0,0 +1,32 @@
+#include "StateMachine/StepWatchdog.h"
+#include "config/Config.h"
+
+static_assert(WATCHDOG_MIN_SAMPLES >= 1 && WATCHDOG_MIN_SAMPLES <= StepWatchdog::HISTORY,
+              "WATCHDOG_MIN_SAMPLES must fit the watchdog history");
+
+void StepWatchdog::record(int step, uint32_t durationUs) {
+    if (step < 0 || step >= MAX_STEPS) return;
+    History& h = steps[step];
+    h.passesUs[h.next] = durationUs;
+    h.next = (h.next + 1) % HISTORY;
+    if (h.count < HISTORY) h.count++;
+
+    h.slowestUs = 0;
+    for (int i = 0; i < h.count; i++) {
+        if (h.passesUs[i] > h.slowestUs) h.slowestUs = h.passesUs[i];
+    }
+}
+
+bool StepWatchdog::learned(int step) const {
+    return step >= 0 && step < MAX_STEPS && steps[step].count >= WATCHDOG_MIN_SAMPLES;
+}
+
+uint32_t StepWatchdog::deadlineMs(int step, uint32_t ceilingMs) const {
+    if (!learned(step)) return ceilingMs;
+    const float deadline = steps[step].slowestUs / 1000.0f * WATCHDOG_FACTOR + WATCHDOG_MARGIN_MS;
+    return deadline < ceilingMs ? (uint32_t)deadline : ceilingMs;
+}
+
+void StepWatchdog::reset() {
+    for (History& h : steps) h = {};
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+
+// ************************************************************************
+// **************************** STEP WATCHDOG *****************************
+// ************************************************************************
+// Deadline for each watched step, learned from how long the step actually
+// takes on this lane: the slowest of its recent passes, times
+// WATCHDOG_FACTOR, plus WATCHDOG_MARGIN_MS. Until a step has been seen
+// WATCHDOG_MIN_SAMPLES times, and whenever the learned deadline would be
+// longer, the step table's timeout applies. Learning starts over when the
+// lane's parameters change, since the old timings no longer hold.
+
+class StepWatchdog {
+public:
+    static const int HISTORY = 8;        // Recent passes per step the deadline is learned from
+    static const int MAX_STEPS = 16;
+
+    void record(int step, uint32_t durationUs);          // A pass that ended normally
+    uint32_t deadlineMs(int step, uint32_t ceilingMs) const;
+    bool learned(int step) const;
+    void reset();
+
+private:
+    struct History {
+        uint32_t passesUs[HISTORY];
+        uint8_t count;
+        uint8_t next;
+        uint32_t slowestUs;
+    };
+    History steps[MAX_STEPS] = {};
+};
@@ -0,0 +1,42 @@
+#include "StateMachine/TriggerQueue.h"
+
+bool TriggerQueue::latch(const Trigger& trigger, const MachineParams& p) {
+    const uint32_t spacingUs = (uint32_t)(p.triggerMinSpacing * 1000.0f);
+    if (haveLast && trigger.edgeUs - lastEdgeUs < spacingUs) {
+        coalesced++;
+        return false;
+    }
+
+    int depth = (int)p.triggerQueueDepth;
+    if (depth > CAPACITY) depth = CAPACITY;
+    if (count >= depth) {
+        dropped++;
+        return false;
+    }
+
+    entries[(head + count) % CAPACITY] = trigger;
+    count++;
+    latched++;
+    haveLast = true;
+    lastEdgeUs = trigger.edgeUs;
+    return true;
+}
+
+bool TriggerQueue::requeue(const Trigger& trigger) {
+    if (count >= CAPACITY) {
+        dropped++;
+        return false;
+    }
+    head = (head + CAPACITY - 1) % CAPACITY;
+    entries[head] = trigger;
+    count++;
+    return true;
+}
+
+bool TriggerQueue::pop(Trigger& trigger) {
+    if (count == 0) return false;
+    trigger = entries[head];
+    head = (head + 1) % CAPACITY;
+    count--;
+    return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include "config/Params.h"
+#include "TelemetryProtocol.h"
+
+// ************************************************************************
+// **************************** START TRIGGERS ****************************
+// ************************************************************************
+// Latches start edges whenever they happen, not only while the lane is in
+// IDLE, so a part that reaches the sensor mid-cycle starts the next cycle
+// instead of being lost. Edges closer than TRIGGER_MIN_SPACING to the last
+// latched one are the same part (sensor chatter, a second button press)
+// and are coalesced; edges beyond TRIGGER_QUEUE_DEPTH are dropped. Both
+// are counted. Control task only.
+
+struct Trigger {
+    TelemetryTrigger source;
+    bool fresh;                // Real edge (false: input already active at power-on)
+    uint32_t edgeUs;           // When it was seen
+};
+
+class TriggerQueue {
+public:
+    static const int CAPACITY = 8;   // Upper bound for TRIGGER_QUEUE_DEPTH
+
+    // Latch one trigger; false if it was coalesced or dropped
+    bool latch(const Trigger& trigger, const MachineParams& p);
+    // Put a trigger at the head, ahead of spacing and depth (fault retries);
+    // false only if the queue is completely full
+    bool requeue(const Trigger& trigger);
+    bool pop(Trigger& trigger);
+    bool pending() const { return count > 0; }
+    void clear() { count = 0; haveLast = false; }   // Counters are kept
+
+    int queued() const { return count; }
+    uint32_t latchedCount() const { return latched; }
+    uint32_t droppedCount() const { return dropped; }       // Queue was full
+    uint32_t coalescedCount() const { return coalesced; }   // Within the minimum spacing
+
+private:
+    Trigger entries[CAPACITY] = {};
+    int head = 0;
+    int count = 0;
+    bool haveLast = false;
+    uint32_t lastEdgeUs = 0;
+    uint32_t latched = 0;
+    uint32_t dropped = 0;
+    uint32_t coalesced = 0;
+};
@@ -0,0 +1,71 @@
+#include "Telemetry.h"
+#include <atomic>
+#include "SpscQueue.h"
+
+static SpscQueue<TelemetryRecord, Telemetry::QUEUE_SIZE> queue;
+static std::atomic<uint32_t> dropped(0);
+static std::atomic<uint32_t> datagrams(0);
+static uint32_t bootIdentifier = 0;
+static uint8_t lanesReported = 1;
+
+// Network task only
+static TelemetryRecord batch[TELEMETRY_MAX_RECORDS];
+static int batchCount = 0;
+static uint32_t batchStartMs = 0;
+static uint32_t lastSendMs = 0;
+static bool sentOnce = false;
+static uint8_t datagram[TELEMETRY_DATAGRAM_MAX];
+
+namespace Telemetry {
+
+void init(uint32_t bootId, uint8_t laneCount) {
+    bootIdentifier = bootId;
+    lanesReported = laneCount;
+}
+
+bool submit(const TelemetryRecord& record) {
+    if (!queue.push(record)) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void poll(uint32_t nowMs) {
+    TelemetryRecord record;
+    while (batchCount < TELEMETRY_MAX_RECORDS && queue.pop(record)) {
+        if (batchCount == 0) batchStartMs = nowMs;
+        batch[batchCount++] = record;
+    }
+    if (batchCount == 0) return;
+
+    const bool full = batchCount == TELEMETRY_MAX_RECORDS;
+    if (!full && nowMs - batchStartMs < FLUSH_MS) return;
+    if (sentOnce && nowMs - lastSendMs < MIN_INTERVAL_MS) return;
+
+    TelemetryHeader header;
+    header.recordCount = (uint8_t)batchCount;
+    header.laneCount = lanesReported;
+    header.bootId = bootIdentifier;
+    header.droppedRecords = dropped.load(std::memory_order_relaxed);
+
+    const size_t length = TelemetryWire::encode(datagram, sizeof(datagram), header, batch);
+    if (length > 0 && transport::send(datagram, length)) {
+        datagrams.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        dropped.fetch_add(batchCount, std::memory_order_relaxed);
+    }
+    batchCount = 0;
+    lastSendMs = nowMs;
+    sentOnce = true;
+}
+
+uint32_t droppedCount() {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+uint32_t sentDatagrams() {
+    return datagrams.load(std::memory_order_relaxed);
+}
+
+} // namespace Telemetry
@@ -0,0 +1,23 @@
+//* ************************************************************************
+//* ********************* TELEMETRY TRANSPORT: WIFI ************************
+//* ************************************************************************
+//! Broadcasts each datagram on the local subnet, so one receiver anywhere on
+//! the shop network hears every machine without per-machine configuration.
+
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "Telemetry.h"
+
+static WiFiUDP udp;
+
+namespace Telemetry {
+namespace transport {
+
+bool send(const uint8_t* data, size_t length) {
+    if (!udp.beginPacket(WiFi.broadcastIP(), TELEMETRY_PORT)) return false;
+    udp.write(data, length);
+    return udp.endPacket() == 1;
+}
+
+} // namespace transport
+} // namespace Telemetry
@@ -0,0 +1,74 @@
+#include "TraceRing.h"
+#include <string.h>
+#include "hal/Hal.h"
+
+static_assert((TRACE_ENTRIES & (TRACE_ENTRIES - 1)) == 0, "TRACE_ENTRIES must be a power of two");
+
+// Reset-surviving layout. The magic pair tells a ring left by an earlier
+// boot from the random contents RTC memory has at power-on.
+struct TraceStore {
+    uint32_t magic;
+    uint32_t magicInverse;
+    uint32_t boot;
+    uint32_t head;          // Entries written this boot; the next goes at head % TRACE_ENTRIES
+    TraceEntry entries[TRACE_ENTRIES];
+};
+
+static const uint32_t TRACE_MAGIC = 0x54524331;   // "TRC1"
+
+static HAL_NOINIT_ATTR TraceStore store;
+static TraceSnapshot previous;
+
+// esp_reset_reason_t order
+static const char* const RESET_REASON_NAMES[] = {
+    "unknown", "power-on", "external pin", "software", "panic", "interrupt watchdog",
+    "task watchdog", "other watchdog", "deep sleep", "brownout", "SDIO",
+};
+
+static void snapshot(uint8_t resetReason, TraceSnapshot& out) {
+    out.valid = true;
+    out.boot = store.boot;
+    out.resetReason = resetReason;
+    out.total = store.head;
+    out.count = store.head < TRACE_ENTRIES ? store.head : TRACE_ENTRIES;
+    const uint32_t first = store.head - out.count;
+    for (uint32_t i = 0; i < out.count; i++) {
+        out.entries[i] = store.entries[(first + i) & (TRACE_ENTRIES - 1)];
+    }
+}
+
+namespace TraceRing {
+
+void init(uint8_t resetReason) {
+    const bool survived = store.magic == TRACE_MAGIC && store.magicInverse == ~TRACE_MAGIC;
+    if (survived) {
+        snapshot(resetReason, previous);
+    } else {
+        memset(&previous, 0, sizeof(previous));
+        store.boot = 0;
+    }
+
+    store.boot++;
+    store.head = 0;
+    store.magic = TRACE_MAGIC;
+    store.magicInverse = ~TRACE_MAGIC;
+}
+
+void record(const TraceEntry& entry) {
+    store.entries[store.head & (TRACE_ENTRIES - 1)] = entry;
+    store.head++;
+}
+
+const TraceSnapshot& lastBoot() {
+    return previous;
+}
+
+void current(TraceSnapshot& out) {
+    snapshot(0, out);
+}
+
+const char* resetReasonName(uint8_t reason) {
+    return reason < sizeof(RESET_REASON_NAMES) / sizeof(RESET_REASON_NAMES[0]) ? RESET_REASON_NAMES[reason] : "?";
+}
+
+} // namespace TraceRing
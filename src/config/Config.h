@@ -1,17 +1,99 @@
 #pragma once
 
+#include <stdint.h>
+
 // ************************************************************************
 // ************************* MACHINE PARAMETERS ***************************
 // ************************************************************************
+// The timings and angles listed in config/Params.h are only the defaults:
+// the running values live in NVS and can be changed without reflashing
+// ("set <name> <value>" over serial or UDP). Everything else is fixed at
+// compile time.
 
 
 // --- TIMING (milliseconds) ---
 // Purpose: Defines wait times and delays for machine operations.
 // ------------------------------------------------------------------------
 const float FEEDING_START_DELAY_1 = 400.0f;  // Delay after start signal before first feeding begins.
-const float FEEDING_START_DELAY_2 = 200.0f;  // Delay after start signal before second feeding begins.
-const float FEED_TIME             = 2500.0f;    // Duration the feed cylinder is active.
-const float SERVO_MOVE_DELAY      = 50.0f;     // Time allotted for the servo to complete its movement.
+const float FEEDING_START_DELAY_2 = 200.0f;  // Minimum time from the start of the servo return before second feeding begins.
+const float FEED_TIME             = 2500.0f;    // Longest the feed cylinder is held active (see FEED STROKE).
+const float SERVO_MOVE_DELAY      = 20.0f;     // Settle allowance after the servo arrives (modelled, or measured with feedback).
+
+
+// --- STEP TIMEOUTS (milliseconds) ---
+// Purpose: Upper bounds for the step watchdog (see WATCHDOG AND FAULT
+// RECOVERY). Self-timed steps have no timeout. See StepTable.h.
+// ------------------------------------------------------------------------
+const uint32_t STEP_TIMEOUT_MARGIN_MS = 500;   // Added to the nominal duration of timed waits.
+const uint32_t SERVO_WAIT_TIMEOUT_MS  = 1500;  // Longest a servo move is waited for.
+
+
+// --- FEED STROKE ---
+// Purpose: Ends each feed as soon as the stroke completes instead of always
+// waiting FEED_TIME. With an end-of-stroke switch fitted (Pins_Definitions.h)
+// the switch ends the feed; the timeout is learned from recent sensed strokes,
+// and a stroke that runs into it is treated as a jam (FAULT).
+// Without the switch there is no measurement to learn from, so every feed
+// is a plain timed stroke of FEED_TIME.
+// ------------------------------------------------------------------------
+const float FEED_MIN_TIME        = 300.0f;   // Learned timeout never drops below this (ms).
+const float FEED_LEARN_MARGIN    = 0.25f;    // Timeout = slowest recent stroke x (1 + margin) ...
+const float FEED_LEARN_MARGIN_MS = 100.0f;   // ... + this fixed margin (ms).
+const float FEED_LEARN_RATE      = 0.25f;    // Fraction of the gap closed per stroke when shrinking the timeout.
+
+
+// --- WATCHDOG AND FAULT RECOVERY ---
+// Purpose: A watched step that overruns its deadline, or a feed stroke that
+// never reaches the end-of-stroke switch, puts the lane into FAULT: cylinder
+// released, servo sent home. It then retries the cycle automatically after
+// FAULT_RETRY_DELAY_MS x attempt, up to FAULT_RETRIES times in a row, and
+// after that waits for the manual start button or the "clear" command.
+// Deadlines are learned per step (StateMachine/StepWatchdog.h); the step
+// table's timeouts are the starting point and upper bound.
+// ------------------------------------------------------------------------
+const int WATCHDOG_MIN_SAMPLES     = 5;        // Passes of a step before its deadline is learned.
+const float WATCHDOG_FACTOR        = 1.5f;     // Deadline = slowest recent pass x factor ...
+const float WATCHDOG_MARGIN_MS     = 200.0f;   // ... + this margin (ms).
+const float FAULT_RETRIES          = 3.0f;     // Automatic retries before the fault latches (0 = always wait for an operator).
+const float FAULT_RETRY_DELAY_MS   = 2000.0f;  // Wait before retry n is n x this (ms).
+
+
+// --- PHASE OVERLAP ---
+// Purpose: Lets the next phase start before the previous one has fully finished.
+// Interlocks in StateMachine/OverlapScheduler.cpp apply regardless of these values.
+// ------------------------------------------------------------------------
+const float CYLINDER_RETURN_TIME       = 300.0f;  // Modelled time for the cylinder to reach its safe position after release (ms).
+const float FLIP_START_RETURN_FRACTION = 0.0f;    // Flip starts once this fraction of the return stroke is done (0 = at release, 1 = fully returned).
+const float FEED2_SAFE_RETURN_ANGLE    = 70.0f;   // Second feed may start once the returning servo passes this angle (degrees).
+
+
+// --- START TRIGGERS ---
+// Purpose: Start edges are latched at any time and queued, so a part that
+// arrives mid-cycle starts the next cycle as soon as the lane is back in IDLE.
+// ------------------------------------------------------------------------
+const float TRIGGER_QUEUE_DEPTH    = 2.0f;    // Starts that can wait for the lane (1..8); more are dropped.
+const float TRIGGER_MIN_SPACING_MS = 250.0f;  // Edges closer than this to the last latched one count as the same part (ms).
+
+
+// --- CONTROL LOOP ---
+// Purpose: Rate of the fixed-period state machine task.
+// ------------------------------------------------------------------------
+const uint32_t CONTROL_TICK_HZ = 1000;  // Tick rate (Hz), at most the 1 kHz FreeRTOS tick. Output edges land on ticks.
+
+
+// --- IDLE SLEEP ---
+// Purpose: Once every lane is waiting with nothing to do, the control task
+// stops ticking and blocks until a start input, a fault retry coming due or
+// a command wakes it. Light sleep also stops the CPU clock between wakes;
+// WiFi stays associated through modem sleep. The LEDC has no clock in light
+// sleep, so the servos lose their holding pulse while asleep: only turn it
+// on for servos that hold position unpowered.
+// ------------------------------------------------------------------------
+const bool IDLE_SLEEP_ENABLED     = true;
+const uint32_t IDLE_SETTLE_MS     = 100;    // Every lane at rest this long before the control task sleeps (ms). Longer than any debounce.
+const uint32_t IDLE_MAX_SLEEP_MS  = 1000;   // Longest sleep without a wake-up, so nothing can be missed for longer (ms).
+const bool IDLE_LIGHT_SLEEP       = false;  // Let the chip light-sleep while the control task sleeps (needs CONFIG_PM_ENABLE).
+const uint32_t IDLE_WAKE_WARN_US  = 1000;   // Log a warning when an input takes longer than this to get the control task running (us).
 
 
 // --- SERVO ANGLES (degrees) ---
@@ -20,4 +102,58 @@ const float SERVO_MOVE_DELAY      = 50.0f;     // Time allotted for the servo to
 const float SERVO_HOME_ANGLE       = 92.0f;   // The safe/home position for the servo.
 const float FLIP_ANGLE             = 10.0f;   // The target angle to flip the material.
 const float SERVO_TEST_START_ANGLE = 150.0f;   // Start angle for the power-on test sequence.
-const float SERVO_TEST_END_ANGLE   = 100.0f;     // End angle for the power-on test sequence. 
\ No newline at end of file
+const float SERVO_TEST_END_ANGLE   = 100.0f;     // End angle for the power-on test sequence.
+
+
+// --- SERVO SIGNAL ---
+// Purpose: Pulse-width range of the flip servos and their PWM setup. Each
+// lane's LEDC channel is in Pins_Definitions.h.
+// The angle-to-duty table in ServoControl is generated from these at compile time.
+// ------------------------------------------------------------------------
+const int SERVO_MIN_PULSE_US   = 500;    // Pulse width at SERVO_MIN_ANGLE.
+const int SERVO_MAX_PULSE_US   = 2500;   // Pulse width at SERVO_MAX_ANGLE.
+const int SERVO_MIN_ANGLE      = 0;      // Lowest commandable angle (degrees).
+const int SERVO_MAX_ANGLE      = 180;    // Highest commandable angle (degrees).
+const int SERVO_PWM_FREQ       = 50;     // PWM frame rate (Hz). Digital servos can run 333.
+const int SERVO_PWM_RESOLUTION = 14;     // PWM duty resolution (bits).
+
+
+
+// --- SERVO MOTION ---
+// Purpose: Limits for the flip motion profile. Raise them until the board
+// starts to get thrown or the arm overshoots, then back off.
+// ------------------------------------------------------------------------
+const float SERVO_MAX_VELOCITY = 600.0f;     // Peak arm speed (deg/s).
+const float SERVO_MAX_ACCEL    = 8000.0f;    // Peak acceleration (deg/s^2).
+const float SERVO_MAX_JERK     = 200000.0f;  // Jerk limit (deg/s^3), 0 = trapezoidal profile.
+const float SERVO_RATED_SPEED  = 600.0f;     // Datasheet no-load speed, models unprofiled write() jumps (deg/s).
+
+
+// --- SERVO FEEDBACK ---
+// Purpose: Servos with a position output (the pot wiper, on the lane's
+// servoFeedback pin in Pins_Definitions.h) end each move on measured
+// arrival: within the tolerance band, nearly still, for the settle time
+// (moveDelay). Without the pin, arrival is the motion profile's model.
+// The ADC is sampled in the background; the control loop only reads the
+// filtered result.
+// ------------------------------------------------------------------------
+const int SERVO_FEEDBACK_MIN_MV        = 330;     // Feedback voltage at SERVO_MIN_ANGLE (mV).
+const int SERVO_FEEDBACK_MAX_MV        = 2970;    // Feedback voltage at SERVO_MAX_ANGLE (mV).
+const int SERVO_FEEDBACK_MARGIN_MV     = 150;     // Readings this far outside that span mean the wire is off; the model is used.
+const uint32_t SERVO_FEEDBACK_SAMPLE_HZ = 500;    // Filtered position updates per second.
+const int SERVO_FEEDBACK_OVERSAMPLE    = 4;       // ADC reads averaged per update.
+const float SERVO_FEEDBACK_FILTER_MS   = 6.0f;    // Low-pass time constant on position and speed (ms).
+const float SERVO_ARRIVE_TOLERANCE     = 2.0f;    // Arrived when within this of the target (degrees).
+const float SERVO_SETTLED_SPEED        = 30.0f;   // ... and moving slower than this (deg/s).
+
+
+// --- INPUT DEBOUNCE (milliseconds) ---
+// Purpose: Lockout window after an accepted edge. The first edge that
+//          changes an input's level is accepted at once, at its own
+//          timestamp; edges within the window after it are ignored as
+//          bounce. A level that differs once the window has passed is
+//          accepted at the time of its last raw edge.
+// ------------------------------------------------------------------------
+const uint16_t START_SENSOR_DEBOUNCE_MS = 5;   // Lockout after a start sensor edge.
+const uint16_t MANUAL_START_DEBOUNCE_MS = 30;  // Lockout after a manual start button edge.
+const uint16_t END_OF_STROKE_DEBOUNCE_MS = 5;  // Lockout after an end-of-stroke switch edge. 
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <type_traits>
+
+#include "hal/Hal.h"
+#include "EdgeInput.h"
+#include "config/Pins_Definitions.h"
+#include "config/Config.h"
+
+// ************************************************************************
+// *********************** HARDWARE BINDINGS ******************************
+// ************************************************************************
+// Binds each lane's pins from Pins_Definitions.h to HAL types at compile
+// time, so every pin access is a direct register access. LaneHardware<N>
+// is a different type for every lane; the state machine picks the lane's
+// type once per call (LaneHardwareSet in StateMachine.cpp) and the step
+// code only sees the plain LaneIo copy, which is the same for every lane.
+
+//! *************************** LANE I/O *********************************
+struct LaneIo {
+    InputState startSensor;
+    InputState manualStart;
+    InputState endOfStroke;        // Never active if not fitted
+    bool feedCylinder;             // Level last written to the cylinder output
+    bool hasEndOfStroke;
+};
+
+template <int LANE>
+struct LaneHardware {
+    static constexpr LanePins PINS = LANE_PINS[LANE];
+    static constexpr bool HAS_END_OF_STROKE = PINS.endOfStroke >= 0;
+
+    // Edge-interrupt inputs, debounced on microsecond edge timestamps
+    EdgeInput<PINS.startSensor, START_SENSOR_DEBOUNCE_MS * 1000UL> startSensor;
+    EdgeInput<PINS.manualStart, MANUAL_START_DEBOUNCE_MS * 1000UL> manualStart;
+
+    // Optional end-of-stroke switch; compiles away when its pin is -1
+    typename std::conditional<HAS_END_OF_STROKE,
+                              EdgeInput<HAS_END_OF_STROKE ? PINS.endOfStroke : 0, END_OF_STROKE_DEBOUNCE_MS * 1000UL>,
+                              NoEdgeInput>::type endOfStroke;
+
+    typedef hal::OutputPin<PINS.feedCylinder> FeedCylinder;
+
+    void begin(LaneIo& io) {
+        startSensor.begin(hal::Pull::Down);
+        manualStart.begin(hal::Pull::Down);
+        endOfStroke.begin(hal::Pull::Down);
+        FeedCylinder::begin();
+        io.hasEndOfStroke = HAS_END_OF_STROKE;
+        copyInputs(io);
+    }
+
+    // Queued edges from the pin-change interrupts
+    void update(LaneIo& io) {
+        startSensor.update();
+        manualStart.update();
+        endOfStroke.update();
+        copyInputs(io);
+    }
+
+    void writeFeedCylinder(LaneIo& io, bool high) {
+        FeedCylinder::write(high ? HIGH : LOW);
+        io.feedCylinder = high;
+    }
+
+private:
+    void copyInputs(LaneIo& io) const {
+        io.startSensor = startSensor.state();
+        io.manualStart = manualStart.state();
+        io.endOfStroke = endOfStroke.state();
+    }
+};
@@ -0,0 +1,231 @@
+#include "config/Params.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include "Seqlock.h"
+
+#if !defined(ROUTER_NATIVE)
+#include <Preferences.h>
+#endif
+
+//* ************************************************************************
+//* ************************** PARAMETER TABLE ****************************
+//* ************************************************************************
+struct ParamInfo {
+    const char* name;
+    size_t offset;
+    float defaultValue;
+    float minValue;
+    float maxValue;
+    Params::Kind kind;
+};
+
+#define MACHINE_PARAM_INFO(field, name, def, lo, hi, kind) { name, offsetof(MachineParams, field), def, lo, hi, Params::kind },
+static const ParamInfo PARAM_INFO[] = { MACHINE_PARAMS(MACHINE_PARAM_INFO) };
+#undef MACHINE_PARAM_INFO
+
+static const int PARAM_COUNT = sizeof(PARAM_INFO) / sizeof(PARAM_INFO[0]);
+
+#define MACHINE_PARAM_DEFAULT(field, name, def, lo, hi, kind) def,
+static const MachineParams DEFAULTS = { MACHINE_PARAMS(MACHINE_PARAM_DEFAULT) };
+#undef MACHINE_PARAM_DEFAULT
+
+static float& field(MachineParams& set, int index) {
+    return *(float*)((char*)&set + PARAM_INFO[index].offset);
+}
+
+static float field(const MachineParams& set, int index) {
+    return *(const float*)((const char*)&set + PARAM_INFO[index].offset);
+}
+
+static int indexOf(const char* name) {
+    for (int i = 0; i < PARAM_COUNT; i++) {
+        if (strcmp(PARAM_INFO[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+static bool inRange(int index, float value) {
+    return value >= PARAM_INFO[index].minValue && value <= PARAM_INFO[index].maxValue;
+}
+
+static bool isWhole(int index, float value) {
+    return PARAM_INFO[index].kind != Params::PARAM_INT || value == (float)(int32_t)value;
+}
+
+// Rules that span more than one parameter
+static bool consistent(const MachineParams& p) {
+    return p.feedMinTime <= p.feedTime && p.flipAngle != p.servoHomeAngle;
+}
+
+//* ************************************************************************
+//* *************************** STAGING ***********************************
+//* ************************************************************************
+// One staging channel per lane
+struct LaneParams {
+    MachineParams requested;                 // Network task only
+    Seqlock<MachineParams> stagedSet;        // Network task -> control task
+    Seqlock<MachineParams> activeSet;        // Control task -> any task
+    std::atomic<bool> pendingFlag;
+};
+
+static LaneParams laneParams[LANE_COUNT];
+
+static bool validLane(int lane) {
+    return lane >= 0 && lane < LANE_COUNT;
+}
+
+//* ************************************************************************
+//* *************************** PERSISTENCE *******************************
+//* ************************************************************************
+#if defined(ROUTER_NATIVE)
+
+// The simulation always starts from the defaults
+static void load(int, MachineParams& set) { set = DEFAULTS; }
+static void save(int, int, float) {}
+
+#else
+
+// Lane 0 keeps the original single-station namespace, so its tuning survives
+static void nvsNamespace(int lane, char* out, size_t size) {
+    if (lane == 0) snprintf(out, size, "router");
+    else snprintf(out, size, "router%d", lane);
+}
+
+static void load(int lane, MachineParams& set) {
+    set = DEFAULTS;
+    char ns[16];
+    nvsNamespace(lane, ns, sizeof(ns));
+    Preferences prefs;
+    if (!prefs.begin(ns, true)) return;   // Nothing saved yet
+    for (int i = 0; i < PARAM_COUNT; i++) {
+        const float stored = prefs.getFloat(PARAM_INFO[i].name, PARAM_INFO[i].defaultValue);
+        if (inRange(i, stored) && isWhole(i, stored)) field(set, i) = stored;
+    }
+    prefs.end();
+    if (!consistent(set)) set = DEFAULTS;
+}
+
+static void save(int lane, int index, float value) {
+    char ns[16];
+    nvsNamespace(lane, ns, sizeof(ns));
+    Preferences prefs;
+    if (!prefs.begin(ns, false)) return;
+    prefs.putFloat(PARAM_INFO[index].name, value);
+    prefs.end();
+}
+
+#endif
+
+namespace Params {
+
+const MachineParams& defaults() {
+    return DEFAULTS;
+}
+
+void init() {
+    for (int lane = 0; lane < LANE_COUNT; lane++) {
+        LaneParams& lp = laneParams[lane];
+        load(lane, lp.requested);
+        lp.stagedSet.write(lp.requested);
+        lp.activeSet.write(lp.requested);
+        lp.pendingFlag.store(false);
+    }
+}
+
+Result stage(int lane, const char* name, float value) {
+    if (!validLane(lane)) return PARAM_UNKNOWN_LANE;
+    const int index = indexOf(name);
+    if (index < 0) return PARAM_UNKNOWN;
+    if (!inRange(index, value)) return PARAM_OUT_OF_RANGE;
+    if (!isWhole(index, value)) return PARAM_NOT_INTEGER;
+
+    LaneParams& lp = laneParams[lane];
+    MachineParams next = lp.requested;
+    field(next, index) = value;
+    if (!consistent(next)) return PARAM_INCONSISTENT;
+
+    lp.requested = next;
+    save(lane, index, value);
+    lp.stagedSet.write(lp.requested);
+    lp.pendingFlag.store(true, std::memory_order_release);
+    return PARAM_OK;
+}
+
+Result stageDefaults(int lane) {
+    if (!validLane(lane)) return PARAM_UNKNOWN_LANE;
+    LaneParams& lp = laneParams[lane];
+    lp.requested = DEFAULTS;
+    for (int i = 0; i < PARAM_COUNT; i++) save(lane, i, PARAM_INFO[i].defaultValue);
+    lp.stagedSet.write(lp.requested);
+    lp.pendingFlag.store(true, std::memory_order_release);
+    return PARAM_OK;
+}
+
+MachineParams staged(int lane) {
+    return laneParams[lane].stagedSet.read();
+}
+
+MachineParams active(int lane) {
+    return laneParams[lane].activeSet.read();
+}
+
+bool pending(int lane) {
+    return laneParams[lane].pendingFlag.load(std::memory_order_acquire);
+}
+
+bool applyPending(int lane, MachineParams& active) {
+    LaneParams& lp = laneParams[lane];
+    if (!lp.pendingFlag.load(std::memory_order_acquire)) return false;
+
+    // A stage() racing with us is either in this copy or re-raises the flag
+    lp.pendingFlag.store(false, std::memory_order_relaxed);
+    MachineParams next;
+    if (!lp.stagedSet.tryRead(next)) {
+        lp.pendingFlag.store(true, std::memory_order_relaxed);   // Mid-write; next tick
+        return false;
+    }
+    if (memcmp(&next, &active, sizeof(active)) == 0) return false;
+    active = next;
+    lp.activeSet.write(active);
+    return true;
+}
+
+int count() {
+    return PARAM_COUNT;
+}
+
+const char* name(int index) {
+    return PARAM_INFO[index].name;
+}
+
+float value(const MachineParams& set, int index) {
+    return field(set, index);
+}
+
+float minValue(int index) {
+    return PARAM_INFO[index].minValue;
+}
+
+float maxValue(int index) {
+    return PARAM_INFO[index].maxValue;
+}
+
+bool isInteger(int index) {
+    return PARAM_INFO[index].kind == PARAM_INT;
+}
+
+const char* resultText(Result result) {
+    switch (result) {
+        case PARAM_OK:           return "ok";
+        case PARAM_UNKNOWN:      return "unknown parameter";
+        case PARAM_OUT_OF_RANGE: return "value out of range";
+        case PARAM_NOT_INTEGER:  return "must be a whole number";
+        case PARAM_INCONSISTENT: return "conflicts with another parameter";
+        case PARAM_UNKNOWN_LANE: return "no such lane";
+    }
+    return "?";
+}
+
+} // namespace Params
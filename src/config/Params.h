@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+#include "config/Config.h"
+#include "config/Pins_Definitions.h"
+
+// ************************************************************************
+// ************************ RUNTIME PARAMETERS ****************************
+// ************************************************************************
+// The tunable timings and angles, persisted in NVS and cached in each
+// lane's Lane::params.
+// Config.h supplies the defaults and the compile-time-only settings.
+//
+// Changes arrive on the network task (serial or UDP commands), are range
+// checked, saved, and staged. The control task takes the staged set as a
+// whole at the next cycle boundary (IDLE), so a cycle never runs with a
+// mix of old and new values. Reading lane.params.x costs the same as
+// reading a constant from RAM.
+//
+// Every lane has its own set (its own NVS namespace), so stations with
+// different cylinders or stock can be tuned independently.
+//
+// Every value is stored as a float. PARAM_INT marks counts, which only
+// take whole numbers; stage() rejects a fraction rather than truncating it.
+//
+//   X(field, name (NVS key), default, min, max, kind)
+#define MACHINE_PARAMS(X) \
+    X(feedingStartDelay1,      "startDelay1",   FEEDING_START_DELAY_1,      0.0f,            5000.0f,         PARAM_REAL) \
+    X(feedingStartDelay2,      "startDelay2",   FEEDING_START_DELAY_2,      0.0f,            5000.0f,         PARAM_REAL) \
+    X(feedTime,                "feedTime",      FEED_TIME,                  100.0f,          10000.0f,        PARAM_REAL) \
+    X(servoMoveDelay,          "moveDelay",     SERVO_MOVE_DELAY,           0.0f,            500.0f,          PARAM_REAL) \
+    X(feedMinTime,             "feedMinTime",   FEED_MIN_TIME,              50.0f,           10000.0f,        PARAM_REAL) \
+    X(feedLearnMargin,         "learnMargin",   FEED_LEARN_MARGIN,          0.0f,            2.0f,            PARAM_REAL) \
+    X(feedLearnMarginMs,       "learnMarginMs", FEED_LEARN_MARGIN_MS,       0.0f,            2000.0f,         PARAM_REAL) \
+    X(feedLearnRate,           "learnRate",     FEED_LEARN_RATE,            0.0f,            1.0f,            PARAM_REAL) \
+    X(cylinderReturnTime,      "cylReturn",     CYLINDER_RETURN_TIME,       0.0f,            5000.0f,         PARAM_REAL) \
+    X(flipStartReturnFraction, "flipStartFrac", FLIP_START_RETURN_FRACTION, 0.0f,            1.0f,            PARAM_REAL) \
+    X(feed2SafeReturnAngle,    "safeRetAngle",  FEED2_SAFE_RETURN_ANGLE,    SERVO_MIN_ANGLE, SERVO_MAX_ANGLE, PARAM_REAL) \
+    X(servoHomeAngle,          "homeAngle",     SERVO_HOME_ANGLE,           SERVO_MIN_ANGLE, SERVO_MAX_ANGLE, PARAM_REAL) \
+    X(flipAngle,               "flipAngle",     FLIP_ANGLE,                 SERVO_MIN_ANGLE, SERVO_MAX_ANGLE, PARAM_REAL) \
+    X(servoMaxVelocity,        "maxVelocity",   SERVO_MAX_VELOCITY,         10.0f,           2000.0f,         PARAM_REAL) \
+    X(servoMaxAccel,           "maxAccel",      SERVO_MAX_ACCEL,            100.0f,          100000.0f,       PARAM_REAL) \
+    X(servoMaxJerk,            "maxJerk",       SERVO_MAX_JERK,             0.0f,            10000000.0f,     PARAM_REAL) \
+    X(servoArriveTolerance,    "arriveTol",     SERVO_ARRIVE_TOLERANCE,     0.2f,            20.0f,           PARAM_REAL) \
+    X(triggerQueueDepth,       "trigDepth",     TRIGGER_QUEUE_DEPTH,        1.0f,            8.0f,            PARAM_INT) \
+    X(triggerMinSpacing,       "trigSpacing",   TRIGGER_MIN_SPACING_MS,     0.0f,            10000.0f,        PARAM_REAL) \
+    X(faultRetries,            "faultRetries",  FAULT_RETRIES,              0.0f,            10.0f,           PARAM_INT) \
+    X(faultRetryDelay,         "retryDelay",    FAULT_RETRY_DELAY_MS,       0.0f,            60000.0f,        PARAM_REAL)
+
+#define MACHINE_PARAM_FIELD(field, name, def, lo, hi, kind) float field;
+struct MachineParams { MACHINE_PARAMS(MACHINE_PARAM_FIELD) };
+#undef MACHINE_PARAM_FIELD
+
+namespace Params {
+
+enum Kind : uint8_t { PARAM_REAL, PARAM_INT };
+
+enum Result : uint8_t { PARAM_OK, PARAM_UNKNOWN, PARAM_OUT_OF_RANGE, PARAM_NOT_INTEGER, PARAM_INCONSISTENT, PARAM_UNKNOWN_LANE };
+
+const MachineParams& defaults();
+
+void init();                       // Load every lane from NVS (defaults for missing/invalid keys)
+
+// --- Network task side ---
+Result stage(int lane, const char* name, float value);   // Validate, save and stage one change
+Result stageDefaults(int lane);                          // Stage and save the Config.h defaults
+MachineParams staged(int lane);                          // Latest requested set (== active once applied)
+MachineParams active(int lane);                          // Copy of the active set, safe from any task
+bool pending(int lane);                                  // Staged changes not yet applied
+
+// --- Control task side ---
+// At the lane's cycle boundary: copy its staged set into `active`; true if it changed
+bool applyPending(int lane, MachineParams& active);
+
+// Enumerate parameters (for listing)
+int count();
+const char* name(int index);
+float value(const MachineParams& set, int index);
+float minValue(int index);
+float maxValue(int index);
+bool isInteger(int index);
+const char* resultText(Result result);
+
+} // namespace Params
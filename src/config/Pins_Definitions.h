@@ -3,13 +3,32 @@
 // ************************************************************************
 // *********************** PIN DEFINITIONS ********************************
 // ************************************************************************
+// One row per lane (an independent feed/flip station). All lanes run from
+// the same control task. To add a station, raise ROUTER_LANE_COUNT and
+// add its row; the second row is the wiring used for a second station.
+// Lane 0 keeps the original single-station wiring. ROUTER_LANE_COUNT may
+// also come from the build flags (see [env:native_bench_2lanes]).
 
-//! *************************** INPUT PINS *******************************
-const int START_SENSOR_PIN = 48;     // Button or sensor to start the cycle
-const int MANUAL_START_PIN = 19;     // Manual start button
+//! *************************** LANES ************************************
+#ifndef ROUTER_LANE_COUNT
+#define ROUTER_LANE_COUNT 1
+#endif
+const int LANE_COUNT = ROUTER_LANE_COUNT;
 
-//! *************************** OUTPUT PINS ******************************
-const int FEED_CYLINDER_PIN = 41;    // Controls the feeding cylinder
+struct LanePins {
+    int startSensor;    // Button or sensor to start the cycle
+    int manualStart;    // Manual start button
+    int endOfStroke;    // Reed switch at the end of the feed stroke (-1 = not fitted)
+    int feedCylinder;   // Controls the feeding cylinder
+    int flipServo;      // Pin for the flipping servo
+    int servoChannel;   // LEDC channel driving that servo (one per lane)
+    int servoFeedback;  // ADC1 pin on the servo's position output (-1 = plain servo)
+};
 
-//! ************************** SERVO PIN *******************************
-const int FLIP_SERVO_PIN = 15; // Pin for the flipping servo 
\ No newline at end of file
+constexpr LanePins LANE_PINS[LANE_COUNT] = {
+    // start  manual  end of stroke  cylinder  servo  LEDC channel  servo feedback
+    {  48,    19,     -1,            41,       15,    0,            -1 },
+#if ROUTER_LANE_COUNT > 1
+    {  47,    21,     -1,            42,       16,    1,            -1 },
+#endif
+};
@@ -10,130 +10,84 @@
  */
 
 #include <Arduino.h>
-#include <Bounce2.h>
 #include "soc/soc.h"
 #include "soc/rtc_cntl_reg.h"
-#include "ServoControl.h" // Include the custom servo library
 
 // ************************************************************************
 // ********************** PROJECT FILES ***********************************
 // ************************************************************************
-#include "config/Pins_Definitions.h"
-#include "config/Config.h"
-
-// ************************************************************************
-// ********************** FORWARD DECLARATIONS ****************************
-// ************************************************************************
-void initOTA();
-void handleOTA();
-void handleStateMachine();
-
-// ************************************************************************
-// ********************** GLOBAL VARIABLES ********************************
-// ************************************************************************
-
-// Create Bounce objects for debouncing
-Bounce startSensorDebouncer = Bounce();
-Bounce manualStartDebouncer = Bounce();
-
-// Create servo object
-ServoControl flipServo;
-
-// Keep track of what the machine is doing
-enum State { S_NONE, S_IDLE, S_FEEDING, S_FLIPPING, S_FEEDING2 };
-State currentState = S_IDLE;
-
-// To prevent log spam, keep track of the last logged state and step
-State lastLoggedState = S_NONE;
-float lastLoggedStep = 0.0f;
-
-// Variables to remember when things started
-unsigned long stateStartTime = 0;
-unsigned long stepStartTime = 0;
-float currentStep = 0.0f; // Using float as requested
-
-// ************************************************************************
-// ********************** HELPER FUNCTIONS ********************************
-// ************************************************************************
-void log_state_step(const char* message) {
-    if (currentState != lastLoggedState || currentStep != lastLoggedStep) {
-        Serial.println(message);
-        lastLoggedState = currentState;
-        lastLoggedStep = currentStep;
-    }
+#include "StateMachine/StateMachine.h"
+#include "config/Params.h"
+#include "Logger.h"
+#include "Telemetry.h"
+#include "TraceRing.h"
+#include "SerialCommands.h"
+#include "ControlTask.h"
+#include "OTA_Manager.h"
+
+// ************************************************************************
+// ************************** TARGET STATS ********************************
+// ************************************************************************
+// The part of "stats" that only the ESP32 build has
+static void printTargetStats(CommandOutput& out) {
+    const TickStats window = ControlTask::lastWindow();
+    out.printf("Control tick (last window): %lu ticks, jitter mean %lu us max %lu us, body max %lu us, %lu overruns\n",
+               (unsigned long)window.ticks, (unsigned long)window.meanJitterUs(),
+               (unsigned long)window.maxJitterUs, (unsigned long)window.maxBodyUs,
+               (unsigned long)window.overruns);
+
+    const IdleStats idle = ControlTask::idleStats();
+    out.printf("Idle sleep: %lu spells, %lu ms asleep, %lu input wakes (wake last %lu us, max %lu us)\n",
+               (unsigned long)idle.sleeps, (unsigned long)idle.sleptMs, (unsigned long)idle.inputWakes,
+               (unsigned long)idle.lastWakeUs, (unsigned long)idle.maxWakeUs);
+
+    out.printf("Network: %s, boot to ready %lu ms, last reconnect %lu ms\n",
+               networkReady() ? "ready" : "not ready",
+               (unsigned long)otaTimeToReadyMs(), (unsigned long)otaLastReconnectMs());
 }
 
-// ************************************************************************
-// ********************** STATE MACHINE FILES *****************************
-// ************************************************************************
-#include "StateMachine/STATES/00_IDLE.h"
-#include "StateMachine/STATES/01_FEEDING.h"
-#include "StateMachine/STATES/02_FLIPPING.h"
-#include "StateMachine/STATES/03_FEEDING2.h"
-
 // ************************************************************************
 // **************************** SETUP *************************************
 // ************************************************************************
 void setup() {
     // --- START SERIAL ---
     Serial.begin(115200);
+
+    // --- START LOG DRAIN TASK ---
+    Logger::init();
     
     // --- DISABLE BROWNOUT DETECTOR ---
     WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
 
-    // Set up the pins
-    pinMode(START_SENSOR_PIN, INPUT_PULLDOWN);
-    pinMode(MANUAL_START_PIN, INPUT_PULLDOWN);
-    pinMode(FEED_CYLINDER_PIN, OUTPUT);
+    // Cycle records go out over UDP once WiFi is up
+    Telemetry::init(esp_random(), LANE_COUNT);
 
-    // Setup the debouncers
-    startSensorDebouncer.attach(START_SENSOR_PIN);
-    startSensorDebouncer.interval(5); // 30ms debounce
-    manualStartDebouncer.attach(MANUAL_START_PIN);
-    manualStartDebouncer.interval(30); // 30ms debounce
+    // Load tuned timings and angles from NVS (Config.h defaults if unset)
+    Params::init();
 
-    // Make sure cylinder starts in safe position (retracted)
-    digitalWrite(FEED_CYLINDER_PIN, LOW); // LOW = extended = safe
+    // Keep the step trail the last boot left in RTC memory, and print it:
+    // resets on the line otherwise leave no record of what the machine was doing
+    TraceRing::init(esp_reset_reason());
+    if (TraceRing::lastBoot().valid) SerialCommands::execute("trace");
 
-    // Configure servo motor and move to home position
-    flipServo.init(FLIP_SERVO_PIN, 0, 50, 14); // pin, channel, frequency, resolution
-    flipServo.write(SERVO_HOME_ANGLE);
+    // Set up pins, debouncers and servo; cylinder and servo go to safe positions
+    initStateMachine();
 
-    // Initialize OTA functionality
+    // Start WiFi/OTA bring-up in the background (does not wait for the AP)
     initOTA();
+
+    SerialCommands::platformStats = printTargetStats;
+
+    // --- START TASKS ---
+    // State machine on core 1 at a fixed tick, WiFi/OTA on core 0
+    ControlTask::start();
+    startNetworkTask();
 }
 
 // ************************************************************************
 // ***************************** LOOP *************************************
 // ************************************************************************
 void loop() {
-    // Update the debouncers
-    startSensorDebouncer.update();
-    manualStartDebouncer.update();
-
-    // Handle Over-The-Air updates
-    handleOTA();
-
-    // Run the state machine
-    handleStateMachine();
+    // Everything runs in the control and network tasks; free this one
+    vTaskDelete(nullptr);
 }
-
-// ************************************************************************
-// ********************** STATE MACHINE HANDLER ***************************
-// ************************************************************************
-void handleStateMachine() {
-    switch (currentState) {
-        case S_IDLE:
-            handleIdleState();
-            break;
-        case S_FEEDING:
-            handleFeedingState();
-            break;
-        case S_FLIPPING:
-            handleFlippingState();
-            break;
-        case S_FEEDING2:
-            handleFeeding2State();
-            break;
-    }
-}
\ No newline at end of file
@@ -0,0 +1,129 @@
+//* ************************************************************************
+//* ******************* NATIVE HAL: SIMULATED HARDWARE *********************
+//* ************************************************************************
+//! Backing storage for the simulated clock, pins and PWM channels used by
+//! the [env:native] build.
+
+#include <string.h>
+#include "hal/Hal.h"
+
+NativeSerial Serial;
+
+namespace hal {
+namespace sim {
+
+uint64_t nowMicros = 0;
+uint8_t pinLevels[NUM_PINS];
+uint32_t pwmDuty[NUM_PWM_CHANNELS];
+uint32_t adcMilliVolts[NUM_PINS];
+
+struct SimTimer {
+    bool created;
+    bool active;
+    uint32_t periodUs;
+    uint64_t nextDueUs;
+    timer::Callback callback;
+    void* arg;
+};
+
+const int MAX_TIMERS = 8;
+static SimTimer timers[MAX_TIMERS];
+
+struct SimInterrupt {
+    gpio::EdgeCallback callback;
+    void* arg;
+};
+
+static SimInterrupt interrupts[NUM_PINS];
+
+void reset() {
+    nowMicros = 0;
+    memset(pinLevels, 0, sizeof(pinLevels));
+    memset(pwmDuty, 0, sizeof(pwmDuty));
+    memset(adcMilliVolts, 0, sizeof(adcMilliVolts));
+    memset(timers, 0, sizeof(timers));
+    memset(interrupts, 0, sizeof(interrupts));
+}
+
+// Earliest active timer due at or before the given time, or -1
+static int nextDueTimer(uint64_t untilUs) {
+    int next = -1;
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        if (timers[i].active && timers[i].nextDueUs <= untilUs &&
+            (next < 0 || timers[i].nextDueUs < timers[next].nextDueUs)) {
+            next = i;
+        }
+    }
+    return next;
+}
+
+void advanceMicros(uint32_t us) {
+    const uint64_t targetUs = nowMicros + us;
+    for (int i = nextDueTimer(targetUs); i >= 0; i = nextDueTimer(targetUs)) {
+        nowMicros = timers[i].nextDueUs;
+        timers[i].nextDueUs += timers[i].periodUs;
+        timers[i].callback(timers[i].arg);
+    }
+    nowMicros = targetUs;
+}
+
+void setInput(int pin, bool level) {
+    if (pin < 0 || pin >= NUM_PINS || (pinLevels[pin] != 0) == level) return;
+    pinLevels[pin] = level;
+    if (interrupts[pin].callback) interrupts[pin].callback(interrupts[pin].arg);
+}
+
+bool getOutput(int pin) {
+    return pin >= 0 && pin < NUM_PINS && pinLevels[pin] != 0;
+}
+
+uint32_t getPwmDuty(int channel) {
+    return channel >= 0 && channel < NUM_PWM_CHANNELS ? pwmDuty[channel] : 0;
+}
+
+void setAdc(int pin, uint32_t milliVolts) {
+    if (pin >= 0 && pin < NUM_PINS) adcMilliVolts[pin] = milliVolts;
+}
+
+} // namespace sim
+
+namespace gpio {
+
+void attachEdgeInterrupt(int pin, EdgeCallback callback, void* arg) {
+    if (pin >= 0 && pin < sim::NUM_PINS) sim::interrupts[pin] = { callback, arg };
+}
+
+void detachEdgeInterrupt(int pin) {
+    if (pin >= 0 && pin < sim::NUM_PINS) sim::interrupts[pin] = { nullptr, nullptr };
+}
+
+} // namespace gpio
+
+namespace timer {
+
+Handle create(Callback callback, void* arg, const char*) {
+    if (!callback) return 0;
+    for (int i = 0; i < sim::MAX_TIMERS; i++) {
+        if (!sim::timers[i].created) {
+            sim::timers[i] = { true, false, 0, 0, callback, arg };
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+void start(Handle handle, uint32_t periodUs) {
+    if (handle <= 0 || handle > sim::MAX_TIMERS || periodUs == 0) return;
+    sim::SimTimer& t = sim::timers[handle - 1];
+    if (!t.created) return;
+    t.active = true;
+    t.periodUs = periodUs;
+    t.nextDueUs = sim::nowMicros + periodUs;
+}
+
+void stop(Handle handle) {
+    if (handle > 0 && handle <= sim::MAX_TIMERS) sim::timers[handle - 1].active = false;
+}
+
+} // namespace timer
+} // namespace hal
@@ -0,0 +1,436 @@
+//* ************************************************************************
+//* ******************* DISCRETE-EVENT MACHINE SIMULATOR *******************
+//* ************************************************************************
+//! See Simulator.h. Virtual time is hal::sim::nowMicros; the firmware sees
+//! it through hal::Clock exactly as it sees the hardware clock on target.
+
+#include "native/Simulator.h"
+#include <math.h>
+#include <deque>
+#include <queue>
+#include <vector>
+#include "LoopProfiler.h"
+
+namespace Sim {
+
+const uint32_t TICK_US = 1000000UL / CONTROL_TICK_HZ;
+const uint32_t MAX_CYCLE_MS = 60000;    // A cycle this long means the machine is stuck
+
+PlantModel defaultPlant() {
+    PlantModel plant;
+    plant.strokeMs = 1800.0f;
+    plant.strokeJitter = 0.05f;
+    plant.returnMs = CYLINDER_RETURN_TIME;
+    plant.servoSpeedDegS = SERVO_RATED_SPEED;
+    plant.indexMs = 300;
+    plant.bufferParts = 4;
+    plant.sensorPulseMs = 0;
+    return plant;
+}
+
+//* ************************************************************************
+//* ***************************** EVENTS ***********************************
+//* ************************************************************************
+enum EventKind : uint8_t { EVT_PART_ARRIVES, EVT_PART_AT_SENSOR, EVT_SENSOR_PULSE_END, EVT_END_OF_STROKE };
+
+struct Event {
+    uint64_t timeUs;
+    uint32_t order;         // Ties run in scheduling order
+    EventKind kind;
+    uint8_t lane;
+    uint64_t arg;           // Arrival time for parts, part number for the pulse, stroke number for the switch
+
+    bool operator>(const Event& other) const {
+        return timeUs != other.timeUs ? timeUs > other.timeUs : order > other.order;
+    }
+};
+
+typedef std::priority_queue<Event, std::vector<Event>, std::greater<Event>> EventQueue;
+
+// xorshift32: the same stream on every host for a given seed
+struct Random {
+    uint32_t state;
+    explicit Random(uint32_t seed) : state(seed ? seed : 1) {}
+    float uniform() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (state >> 8) * (1.0f / 16777216.0f);
+    }
+};
+
+static uint64_t now() { return hal::sim::nowMicros; }
+
+//* ************************************************************************
+//* ***************************** STATION **********************************
+//* ************************************************************************
+// The physical side of one lane: its infeed, cylinder and flip arm. Each
+// station draws from its own random stream, so adding a lane leaves the
+// others' part arrivals and strokes exactly as they were.
+class Station {
+public:
+    Station(const Scenario& s, Result& r, EventQueue& q, uint32_t& order, Lane& l)
+        : scenario(s), result(r), events(q), eventOrder(order), lane(l), pins(LANE_PINS[l.id]),
+          random(s.seed + l.id) {}
+
+    void start();
+    void handle(const Event& event);
+    void updatePlant(uint32_t elapsedUs);
+    void observe();
+    bool quiescent() const;
+    // A cycle that never ends, or a part left waiting at an idle lane
+    bool stuck() const {
+        const uint64_t limitUs = MAX_CYCLE_MS * 1000ULL;
+        if (lane.state != S_IDLE) return now() - cycleStartUs > limitUs;
+        return partAtSensor && now() - partAtSensorUs > limitUs;
+    }
+
+private:
+    const Scenario& scenario;
+    Result& result;
+    EventQueue& events;
+    uint32_t& eventOrder;
+    Lane& lane;
+    const LanePins& pins;
+    Random random;
+
+    // Infeed
+    std::deque<uint64_t> buffered;      // Arrival times of queued parts
+    bool partAtSensor = false;
+    bool partIndexing = false;
+    uint64_t sensorPartArrivalUs = 0;
+    uint64_t partAtSensorUs = 0;
+    uint64_t partNumber = 0;            // Parts that have reached the sensor
+
+    // Feed cylinder: position 0 (safe) .. 1 (end of stroke), piecewise linear
+    bool driven = false;
+    uint64_t cylinderSinceUs = 0;
+    float cylinderFrom = 0.0f;
+    float strokeUs = 0.0f;
+    float releasedAt = 0.0f;
+    uint64_t strokeNumber = 0;
+
+    // Flip arm
+    float armAngle = 0.0f;
+
+    // Observation
+    uint64_t observedUs = 0;
+    State lastState = S_NONE;
+    StepId lastStep = ST_IDLE_WAIT_START;
+    uint32_t lastStarts = 0;            // Cycle boundaries, counted from the lane's step entries:
+    uint32_t lastIdles = 0;             // a cycle can end and the next start on the same tick
+    uint32_t faultsAtStart = 0;
+    uint64_t cycleStartUs = 0;
+
+    void schedule(uint64_t timeUs, EventKind kind, uint64_t arg) {
+        events.push({ timeUs, eventOrder++, kind, lane.id, arg });
+    }
+
+    void scheduleArrival() {
+        const float gapMs = scenario.arrivals == ARRIVE_POISSON
+                          ? -logf(1.0f - random.uniform()) * scenario.intervalMs
+                          : (float)scenario.intervalMs;
+        schedule(now() + (uint64_t)(gapMs * 1000.0f), EVT_PART_ARRIVES, 0);
+    }
+
+    void indexPart(uint64_t arrivalUs) {
+        partIndexing = true;
+        schedule(now() + scenario.plant.indexMs * 1000ULL, EVT_PART_AT_SENSOR, arrivalUs);
+    }
+
+    float cylinderPosition() const {
+        const float elapsedUs = (float)(now() - cylinderSinceUs);
+        if (driven) return fminf(1.0f, cylinderFrom + elapsedUs / strokeUs);
+        return fmaxf(0.0f, cylinderFrom - elapsedUs / (scenario.plant.returnMs * 1000.0f));
+    }
+
+    // A feedback servo's position output for an arm angle
+    static uint32_t feedbackMilliVolts(float angle) {
+        return (uint32_t)(SERVO_FEEDBACK_MIN_MV + (angle - SERVO_MIN_ANGLE) * (SERVO_FEEDBACK_MAX_MV - SERVO_FEEDBACK_MIN_MV) /
+                                                  (SERVO_MAX_ANGLE - SERVO_MIN_ANGLE) + 0.5f);
+    }
+
+    // Angle the servo is being told to hold, from the PWM pulse width
+    float commandedAngle() const {
+        const uint32_t duty = hal::sim::getPwmDuty(pins.servoChannel);
+        if (duty == 0) return armAngle;
+        const float maxDuty = (float)((1UL << SERVO_PWM_RESOLUTION) - 1);
+        const float pulseUs = duty * 1e6f / (maxDuty * SERVO_PWM_FREQ);
+        return SERVO_MIN_ANGLE + (pulseUs - SERVO_MIN_PULSE_US) * (SERVO_MAX_ANGLE - SERVO_MIN_ANGLE) /
+                                 (float)(SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US);
+    }
+};
+
+void Station::start() {
+    armAngle = lane.params.servoHomeAngle;
+    if (pins.servoFeedback >= 0) hal::sim::setAdc(pins.servoFeedback, feedbackMilliVolts(armAngle));
+    lastState = lane.state;
+    lastStep = lane.step;
+    lastStarts = lane.stepStats[ST_FEED1_WAIT_DELAY].entries;
+    lastIdles = lane.stepStats[ST_IDLE_WAIT_START].entries;
+
+    if (scenario.arrivals == ARRIVE_SATURATED) indexPart(0);
+    else schedule(0, EVT_PART_ARRIVES, 0);
+}
+
+void Station::handle(const Event& event) {
+    switch (event.kind) {
+        case EVT_PART_ARRIVES:
+            if (!partAtSensor && !partIndexing) indexPart(now());
+            else if (buffered.size() < scenario.plant.bufferParts) buffered.push_back(now());
+            else result.partsTurnedAway++;
+            scheduleArrival();
+            break;
+
+        case EVT_PART_AT_SENSOR:
+            partIndexing = false;
+            partAtSensor = true;
+            partAtSensorUs = now();
+            sensorPartArrivalUs = event.arg;
+            partNumber++;
+            hal::sim::setInput(pins.startSensor, true);
+            if (scenario.plant.sensorPulseMs) {
+                schedule(now() + scenario.plant.sensorPulseMs * 1000ULL, EVT_SENSOR_PULSE_END, partNumber);
+            }
+            break;
+
+        case EVT_SENSOR_PULSE_END:
+            // The part stays in place; only the sensor signal ends
+            if (event.arg == partNumber) hal::sim::setInput(pins.startSensor, false);
+            break;
+
+        case EVT_END_OF_STROKE:
+            if (event.arg == strokeNumber && driven) hal::sim::setInput(pins.endOfStroke, true);
+            break;
+    }
+}
+
+void Station::updatePlant(uint32_t elapsedUs) {
+    // Arm: slew-rate limited towards the commanded angle
+    const float target = commandedAngle();
+    const float step = scenario.plant.servoSpeedDegS * elapsedUs * 1e-6f;
+    if (fabsf(target - armAngle) <= step) armAngle = target;
+    else armAngle += target > armAngle ? step : -step;
+    if (pins.servoFeedback >= 0) hal::sim::setAdc(pins.servoFeedback, feedbackMilliVolts(armAngle));
+
+    // Cylinder: follow the output; the end-of-stroke switch opens on release
+    const bool output = hal::sim::getOutput(pins.feedCylinder);
+    if (output == driven) return;
+
+    cylinderFrom = cylinderPosition();
+    cylinderSinceUs = now();
+    driven = output;
+    strokeNumber++;
+    if (driven) {
+        const float jitter = 1.0f + scenario.plant.strokeJitter * (2.0f * random.uniform() - 1.0f);
+        strokeUs = scenario.plant.strokeMs * 1000.0f * jitter;
+        schedule(now() + (uint64_t)((1.0f - cylinderFrom) * strokeUs), EVT_END_OF_STROKE, strokeNumber);
+
+        // The first feed stroke pushes the part off the start sensor
+        if (lane.state == S_FEEDING && partAtSensor) {
+            partAtSensor = false;
+            hal::sim::setInput(pins.startSensor, false);
+            if (scenario.arrivals == ARRIVE_SATURATED) {
+                indexPart(now());
+            } else if (!buffered.empty()) {
+                indexPart(buffered.front());
+                buffered.pop_front();
+            }
+        }
+
+        // Second feed: how far past the firmware's safe angle the real arm is
+        if (lane.state == S_FEEDING2) {
+            const MachineParams& p = lane.params;
+            const bool homeAbove = p.servoHomeAngle > p.flipAngle;
+            const float margin = homeAbove ? armAngle - p.feed2SafeReturnAngle : p.feed2SafeReturnAngle - armAngle;
+            if (margin < result.feed2ArmMarginDeg) result.feed2ArmMarginDeg = margin;
+        }
+    } else {
+        releasedAt = cylinderFrom;
+        hal::sim::setInput(pins.endOfStroke, false);
+    }
+}
+
+// Attribute the time since the last observation to the step that was
+// running, and pick up cycle boundaries
+void Station::observe() {
+    const uint64_t elapsedUs = now() - observedUs;
+    observedUs = now();
+    result.stepUs[lastStep] += elapsedUs;
+    result.stateUs[lastState] += elapsedUs;
+    if (lastState == S_IDLE) result.idleUs += elapsedUs;
+
+    if (lane.step != lastStep && lane.step == ST_FLIP_WAIT_OUT) {
+        const float returned = releasedAt > 0.0f ? (releasedAt - cylinderPosition()) / releasedAt : 1.0f;
+        if (returned < result.flipCylinderReturned) result.flipCylinderReturned = returned;
+    }
+    const uint32_t idles = lane.stepStats[ST_IDLE_WAIT_START].entries;
+    if (idles != lastIdles) {
+        lastIdles = idles;
+        if (lane.faults == faultsAtStart) {
+            result.cycleUs.record((uint32_t)(now() - cycleStartUs));
+            result.cycles++;
+        }
+    }
+    const uint32_t starts = lane.stepStats[ST_FEED1_WAIT_DELAY].entries;
+    if (starts != lastStarts) {
+        lastStarts = starts;
+        faultsAtStart = lane.faults;
+        cycleStartUs = now();
+        result.waitUs.record((uint32_t)(now() - sensorPartArrivalUs));
+    }
+    lastStep = lane.step;
+    lastState = lane.state;
+}
+
+// Nothing can happen before the next event: idle, no part waiting, arm and
+// cylinder at rest, and the firmware itself would stop ticking the lane
+bool Station::quiescent() const {
+    return lane.state == S_IDLE && !partAtSensor && !driven && cylinderPosition() <= 0.0f &&
+           armAngle == commandedAngle() && laneRestMs(lane) == LANE_REST_FOREVER;
+}
+
+//* ************************************************************************
+//* ****************************** PLANT ***********************************
+//* ************************************************************************
+// The stations of every simulated lane, the shared event queue and the
+// control task that ticks all lanes in turn
+class Plant {
+public:
+    Plant(const Scenario& s, Result& r) : scenario(s), result(r) {}
+
+    bool run();
+
+private:
+    const Scenario& scenario;
+    Result& result;
+    EventQueue events;
+    uint32_t eventOrder = 0;
+    std::deque<Station> stations;
+
+    void tick();
+    void updatePlant(uint32_t elapsedUs) {
+        for (Station& station : stations) station.updatePlant(elapsedUs);
+    }
+    void observe() {
+        for (Station& station : stations) station.observe();
+    }
+    bool quiescent() const {
+        for (const Station& station : stations) {
+            if (!station.quiescent()) return false;
+        }
+        return !events.empty();
+    }
+    bool stuck() const {
+        for (const Station& station : stations) {
+            if (station.stuck()) return true;
+        }
+        return false;
+    }
+};
+
+// One control task iteration, as ControlTask runs it on the target
+void Plant::tick() {
+    const uint32_t startUs = hal::Clock::micros();
+    for (Lane& lane : lanes) {
+        PROFILE_SECTION(SEC_INPUTS, updateInputs(lane));
+        PROFILE_SECTION(SEC_STATE_MACHINE, handleStateMachine(lane));
+    }
+    LoopProfiler::recordIteration(LoopProfiler::LOOP_CONTROL, hal::Clock::micros() - startUs);
+    Logger::drain();
+    result.ticks++;
+}
+
+bool Plant::run() {
+    hal::sim::reset();
+    initStateMachine();
+    for (uint8_t i = 0; i < result.lanes; i++) {
+        stations.emplace_back(scenario, result, events, eventOrder, lanes[i]);
+        stations.back().start();
+    }
+
+    while (result.cycles < scenario.cycles) {
+        // Skip idle ticks up to the one just before the next event
+        if (quiescent() && events.top().timeUs > now() + TICK_US) {
+            const uint64_t lastIdleTick = (events.top().timeUs - 1) / TICK_US * TICK_US;
+            if (lastIdleTick > now()) {
+                result.ticksSkipped += (lastIdleTick - now()) / TICK_US;
+                hal::sim::advanceMicros((uint32_t)(lastIdleTick - now()));
+                observe();
+            }
+        }
+
+        // Events due before the next tick happen at their own times
+        const uint64_t tickUs = now() + TICK_US;
+        while (!events.empty() && events.top().timeUs <= tickUs) {
+            const Event event = events.top();
+            events.pop();
+            if (event.timeUs > now()) {
+                const uint32_t stepUs = (uint32_t)(event.timeUs - now());
+                hal::sim::advanceMicros(stepUs);
+                updatePlant(stepUs);
+            }
+            stations[event.lane].handle(event);
+        }
+        const uint32_t stepUs = (uint32_t)(tickUs - now());
+        hal::sim::advanceMicros(stepUs);
+        updatePlant(stepUs);
+        tick();
+        updatePlant(0);   // Outputs written this tick take effect now
+        observe();
+
+        if (stuck()) return false;
+    }
+    result.elapsedUs = now();
+    return true;
+}
+
+//* ************************************************************************
+//* ******************************* RUN ************************************
+//* ************************************************************************
+// Lane counters summed over every lane, so a run can report its own share
+struct LaneCounters {
+    uint32_t stepTimeouts = 0;
+    uint32_t triggersDropped = 0;
+    uint32_t triggersCoalesced = 0;
+    uint32_t faults = 0;
+
+    LaneCounters() {
+        for (const Lane& lane : lanes) {
+            for (const StepStats& stats : lane.stepStats) stepTimeouts += stats.timeouts;
+            triggersDropped += lane.triggers.droppedCount();
+            triggersCoalesced += lane.triggers.coalescedCount();
+            faults += lane.faults;
+        }
+    }
+};
+
+bool run(const Scenario& scenario, Result& result) {
+    result.lanes = scenario.lanes < 1 ? 1 : scenario.lanes > LANE_COUNT ? LANE_COUNT : scenario.lanes;
+    result.cycles = 0;
+    result.elapsedUs = 0;
+    result.idleUs = 0;
+    for (uint64_t& us : result.stateUs) us = 0;
+    for (uint64_t& us : result.stepUs) us = 0;
+    result.cycleUs.reset();
+    result.waitUs.reset();
+    result.partsTurnedAway = 0;
+    result.feed2ArmMarginDeg = INFINITY;
+    result.flipCylinderReturned = INFINITY;
+    result.ticks = 0;
+    result.ticksSkipped = 0;
+
+    const LaneCounters before;
+
+    Plant plant(scenario, result);
+    const bool finished = plant.run();
+
+    const LaneCounters after;
+    result.stepTimeouts = after.stepTimeouts - before.stepTimeouts;
+    result.triggersDropped = after.triggersDropped - before.triggersDropped;
+    result.triggersCoalesced = after.triggersCoalesced - before.triggersCoalesced;
+    result.faults = after.faults - before.faults;
+    return finished;
+}
+
+} // namespace Sim
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+#include "Histogram.h"
+#include "StateMachine/StateMachine.h"
+
+//* ************************************************************************
+//* ******************* DISCRETE-EVENT MACHINE SIMULATOR *******************
+//* ************************************************************************
+//! Runs the real state machine (the same STATES/ handlers, step table and
+//! params as the firmware) in virtual time against a model of the machine
+//! it drives:
+//!   - parts arrive at the infeed on a script (saturated, periodic or
+//!     Poisson), queue in a small buffer, and are indexed onto the start
+//!     sensor one at a time; the first feed stroke takes the part away
+//!   - the feed cylinder moves at a modelled stroke/return speed and closes
+//!     the end-of-stroke switch if one is fitted
+//!   - the flip arm follows the servo PWM pulse at the servo's rated speed,
+//!     and drives the servo's position output if the lane has one fitted
+//! Each simulated lane gets its own infeed, cylinder and arm on that lane's
+//! pins, and its own arrival stream; the control task ticks every lane, as
+//! on the target. Part arrivals and switch edges are events at exact
+//! microsecond times; the control task is the periodic tick in between. While the
+//! machine is idle with nothing to do, time jumps straight to the next
+//! event. A run with a given scenario and seed is exactly repeatable.
+
+namespace Sim {
+
+enum Arrivals : uint8_t {
+    ARRIVE_SATURATED,   // A part is always waiting: measures peak throughput
+    ARRIVE_PERIODIC,    // One part every intervalMs
+    ARRIVE_POISSON,     // Random arrivals, mean gap intervalMs
+};
+
+// The physical machine, as opposed to the firmware's model of it
+struct PlantModel {
+    float strokeMs;         // Feed cylinder full stroke
+    float strokeJitter;     // +/- fraction, drawn per stroke
+    float returnMs;         // Cylinder back to its safe position after release
+    float servoSpeedDegS;   // Arm slew rate under load
+    uint32_t indexMs;       // Next queued part reaching the start sensor
+    uint32_t sensorPulseMs; // 0: the part holds the sensor until fed; else the sensor only pulses
+    uint8_t bufferParts;    // Parts the infeed can queue; more are turned away
+};
+
+PlantModel defaultPlant();
+
+struct Scenario {
+    const char* name;
+    Arrivals arrivals;
+    uint32_t intervalMs;
+    uint32_t cycles;        // Run until this many parts are finished
+    uint32_t seed;
+    PlantModel plant;
+    uint8_t lanes;          // Lanes fed with parts (1..LANE_COUNT); the rest stay idle
+};
+
+// Totals over every simulated lane: time sums are lane-time, so they add up
+// to lanes x elapsedUs
+struct Result {
+    uint8_t lanes;
+    uint32_t cycles;        // Parts finished without a fault
+    uint64_t elapsedUs;     // Virtual time from power-on to the last part finished
+    uint64_t idleUs;
+    uint64_t stateUs[S_COUNT];
+    uint64_t stepUs[ST_COUNT];
+    Histogram cycleUs;      // Leaving IDLE to back in IDLE
+    Histogram waitUs;       // Part arrival to its cycle starting
+    uint32_t partsTurnedAway;
+    uint32_t stepTimeouts;
+    uint32_t triggersDropped;     // Start edges the trigger queue had no room for
+    uint32_t triggersCoalesced;   // Start edges within the minimum part spacing
+    uint32_t faults;              // Lane faults; a faulted cycle is retried, not counted as a part
+
+    // Firmware overlap assumptions checked against the plant (worst cycle)
+    float feed2ArmMarginDeg;     // Arm past the safe angle when feed 2 started (< 0: short of it)
+    float flipCylinderReturned;  // Fraction of the return stroke done when the arm moved out
+
+    uint64_t ticks;              // Control ticks actually executed
+    uint64_t ticksSkipped;       // Idle ticks jumped over
+
+    double partsPerHour() const { return elapsedUs ? cycles * 3600e6 / (double)elapsedUs : 0.0; }
+    double laneUs() const { return (double)elapsedUs * lanes; }
+    double idleFraction() const { return elapsedUs ? idleUs / laneUs() : 0.0; }
+};
+
+// Run one scenario from power-on. Params staged before the call take
+// effect at the first IDLE tick, exactly as on the machine.
+bool run(const Scenario& scenario, Result& result);
+
+} // namespace Sim
@@ -0,0 +1,32 @@
+//* ************************************************************************
+//* ******************* TELEMETRY TRANSPORT: LOOPBACK **********************
+//* ************************************************************************
+//! The native build sends its datagrams to 127.0.0.1:TELEMETRY_PORT, so
+//! tools/telemetry_receiver can be pointed at a simulated machine.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Telemetry.h"
+
+static int sock = -1;
+static sockaddr_in destination;
+
+namespace Telemetry {
+namespace transport {
+
+bool send(const uint8_t* data, size_t length) {
+    if (sock < 0) {
+        sock = socket(AF_INET, SOCK_DGRAM, 0);
+        if (sock < 0) return false;
+        destination = {};
+        destination.sin_family = AF_INET;
+        destination.sin_port = htons(TELEMETRY_PORT);
+        destination.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    }
+    return sendto(sock, data, length, 0, (const sockaddr*)&destination, sizeof(destination)) == (ssize_t)length;
+}
+
+} // namespace transport
+} // namespace Telemetry
@@ -0,0 +1,253 @@
+/*
+ * Throughput benchmark for the router cycle.
+ *
+ * Runs the firmware state machine through the discrete-event simulator
+ * (native/Simulator.h) for a fixed set of part-arrival scenarios and
+ * reports parts/hour, idle fraction and where the cycle time goes. The
+ * results are compared with a checked-in baseline; a drop in throughput or
+ * a rise in cycle/wait time beyond the threshold fails the run.
+ *
+ *   pio run -e native_bench && .pio/build/native_bench/program [options]
+ *
+ *   --set name=value     Override a parameter on every lane (any name from "params"); repeatable
+ *   --scenario name      Run only this scenario
+ *   --baseline file      Baseline to compare with (default src/native/bench/baseline.txt)
+ *   --threshold pct      Allowed regression per metric (default 2)
+ *   --write-baseline     Save this run as the new baseline instead of comparing
+ *
+ * Exit status: 0 passed, 1 regression (or a stuck machine), 2 bad options,
+ * 3 a metric has no baseline entry (write a new baseline to add it).
+ *
+ * Runs are deterministic: the same tree and options give the same numbers
+ * on every host, so any change in the report comes from the code or the
+ * parameters.
+ */
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "native/Simulator.h"
+#include "StateMachine/StateMachine.h"
+
+// ************************************************************************
+// ****************************** SCENARIOS *******************************
+// ************************************************************************
+// Nominal cycle is just under 6 s; 7 s arrivals load the machine to ~85%.
+// The two-lane runs feed both lanes from one controller: they should match
+// their single-lane counterparts per lane, at twice the parts/hour. They
+// are skipped while the build has fewer lanes (LANE_COUNT);
+// [env:native_bench_2lanes] runs them. The
+// pulsed run has a sensor that only pulses as each part arrives, which is
+// mid-cycle when parts are waiting: every pulse has to be latched.
+static std::vector<Sim::Scenario> scenarios() {
+    const Sim::PlantModel plant = Sim::defaultPlant();
+    Sim::PlantModel pulsedSensor = plant;
+    pulsedSensor.sensorPulseMs = 50;
+    return {
+        { "saturated",   Sim::ARRIVE_SATURATED, 0,    2000, 1,  plant, 1 },
+        { "periodic",    Sim::ARRIVE_PERIODIC,  7000, 1000, 1,  plant, 1 },
+        { "poisson",     Sim::ARRIVE_POISSON,   7000, 1000, 42, plant, 1 },
+        { "saturated2",  Sim::ARRIVE_SATURATED, 0,    4000, 1,  plant, 2 },
+        { "poisson2",    Sim::ARRIVE_POISSON,   7000, 2000, 42, plant, 2 },
+        { "pulsed",      Sim::ARRIVE_POISSON,   7000, 1000, 42, pulsedSensor, 1 },
+    };
+}
+
+// ************************************************************************
+// ******************************* METRICS ********************************
+// ************************************************************************
+// Metrics the baseline gates, and which direction is a regression
+struct Metric {
+    std::string scenario;
+    const char* name;
+    double value;
+    bool higherIsBetter;
+};
+
+static void collect(const Sim::Scenario& scenario, const Sim::Result& r, std::vector<Metric>& metrics) {
+    metrics.push_back({ scenario.name, "parts_per_hour", r.partsPerHour(), true });
+    metrics.push_back({ scenario.name, "cycle_p99_ms", r.cycleUs.percentile(990) / 1000.0, false });
+    if (scenario.arrivals != Sim::ARRIVE_SATURATED) {
+        metrics.push_back({ scenario.name, "wait_p99_ms", r.waitUs.percentile(990) / 1000.0, false });
+    }
+}
+
+static void report(const Sim::Scenario& scenario, const Sim::Result& r, double wallSeconds) {
+    printf("\n=== %s: %lu parts on %u lane%s, %.1f h simulated in %.2f s ===\n", scenario.name,
+           (unsigned long)r.cycles, r.lanes, r.lanes == 1 ? "" : "s", r.elapsedUs / 3600e6, wallSeconds);
+    printf("  throughput      %.1f parts/hour\n", r.partsPerHour());
+    printf("  idle fraction   %.1f%%\n", 100.0 * r.idleFraction());
+    printf("  cycle           mean %.0f ms, p50 %.0f, p99 %.0f, max %.0f\n", r.cycleUs.mean() / 1000.0,
+           r.cycleUs.percentile(500) / 1000.0, r.cycleUs.percentile(990) / 1000.0, r.cycleUs.max() / 1000.0);
+    if (scenario.arrivals != Sim::ARRIVE_SATURATED) {
+        printf("  part wait       mean %.0f ms, p99 %.0f, %lu turned away (buffer full)\n",
+               r.waitUs.mean() / 1000.0, r.waitUs.percentile(990) / 1000.0, (unsigned long)r.partsTurnedAway);
+    }
+    printf("  overlap checks  arm %+.1f deg past safe angle at feed 2, cylinder %.0f%% returned at flip (worst)\n",
+           r.feed2ArmMarginDeg, 100.0 * r.flipCylinderReturned);
+    if (r.stepTimeouts) printf("  step timeouts   %lu\n", (unsigned long)r.stepTimeouts);
+    if (r.faults) printf("  faults          %lu (cycles retried)\n", (unsigned long)r.faults);
+    if (r.triggersDropped || r.triggersCoalesced) {
+        printf("  start triggers  %lu dropped (queue full), %lu coalesced\n", (unsigned long)r.triggersDropped,
+               (unsigned long)r.triggersCoalesced);
+    }
+
+    printf("  %-10s %7s\n", "phase", "share");
+    for (int s = S_IDLE; s < S_COUNT; s++) {
+        printf("  %-10s %6.1f%%\n", stateName((State)s), 100.0 * r.stateUs[s] / r.laneUs());
+    }
+    printf("  %-22s %12s\n", "step", "ms per part");
+    for (int i = 0; i < ST_COUNT; i++) {
+        const StepDef& def = stepDef((StepId)i);
+        printf("  %-22s %12.1f\n", def.name, r.stepUs[i] / 1000.0 / (r.cycles ? r.cycles : 1));
+    }
+    printf("  (%llu control ticks run, %llu idle ticks skipped)\n", (unsigned long long)r.ticks,
+           (unsigned long long)r.ticksSkipped);
+}
+
+// ************************************************************************
+// ******************************* BASELINE *******************************
+// ************************************************************************
+// One "scenario metric value" per line; '#' starts a comment
+static bool writeBaseline(const char* path, const std::vector<Metric>& metrics) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "# Router throughput baseline, written by native_bench --write-baseline\n");
+    for (const Metric& m : metrics) fprintf(f, "%s %s %.3f\n", m.scenario.c_str(), m.name, m.value);
+    return fclose(f) == 0;
+}
+
+static bool findBaseline(const char* path, const Metric& metric, double& value) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    char line[160], scenario[64], name[64];
+    bool found = false;
+    while (!found && fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') continue;
+        found = sscanf(line, "%63s %63s %lf", scenario, name, &value) == 3 &&
+                metric.scenario == scenario && strcmp(metric.name, name) == 0;
+    }
+    fclose(f);
+    return found;
+}
+
+// Returns the number of regressions; metrics the baseline has no entry for
+// are counted in `missing`
+static int compare(const char* path, const std::vector<Metric>& metrics, double thresholdPct, int& missing) {
+    printf("\n=== Against %s (threshold %.1f%%) ===\n", path, thresholdPct);
+    int regressions = 0;
+    missing = 0;
+    for (const Metric& m : metrics) {
+        double base;
+        if (!findBaseline(path, m, base)) {
+            printf("  %-10s %-15s %10.1f   NO BASELINE\n", m.scenario.c_str(), m.name, m.value);
+            missing++;
+            continue;
+        }
+        const double changePct = base != 0.0 ? 100.0 * (m.value - base) / fabs(base) : 0.0;
+        const bool regressed = m.higherIsBetter ? changePct < -thresholdPct : changePct > thresholdPct;
+        printf("  %-10s %-15s %10.1f   baseline %10.1f   %+6.2f%%%s\n", m.scenario.c_str(), m.name, m.value, base,
+               changePct, regressed ? "   REGRESSION" : "");
+        if (regressed) regressions++;
+    }
+    return regressions;
+}
+
+// ************************************************************************
+// ********************************* MAIN *********************************
+// ************************************************************************
+int main(int argc, char** argv) {
+    const char* baselinePath = "src/native/bench/baseline.txt";
+    const char* only = nullptr;
+    double thresholdPct = 2.0;
+    bool updateBaseline = false;
+
+    Logger::init();
+    Params::init();
+    Serial.setQuiet(true);   // State machine log output; the report uses printf
+
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--set") == 0 && hasValue) {
+            char name[48];
+            float value;
+            const char* arg = argv[++i];
+            const char* eq = strchr(arg, '=');
+            if (!eq || eq - arg >= (int)sizeof(name) || sscanf(eq + 1, "%f", &value) != 1) {
+                fprintf(stderr, "--set expects name=value, got \"%s\"\n", arg);
+                return 2;
+            }
+            memcpy(name, arg, eq - arg);
+            name[eq - arg] = '\0';
+            for (int lane = 0; lane < LANE_COUNT; lane++) {
+                const Params::Result result = Params::stage(lane, name, value);
+                if (result != Params::PARAM_OK) {
+                    fprintf(stderr, "%s: %s\n", arg, Params::resultText(result));
+                    return 2;
+                }
+            }
+            printf("Parameter %s = %g\n", name, value);
+        } else if (strcmp(argv[i], "--scenario") == 0 && hasValue) {
+            only = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && hasValue) {
+            baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && hasValue) {
+            thresholdPct = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--write-baseline") == 0) {
+            updateBaseline = true;
+        } else {
+            fprintf(stderr, "Unknown option %s (see the top of src/native/bench/main.cpp)\n", argv[i]);
+            return 2;
+        }
+    }
+
+    std::vector<Metric> metrics;
+    static Sim::Result result;
+    for (const Sim::Scenario& scenario : scenarios()) {
+        if (only && strcmp(only, scenario.name) != 0) continue;
+        if (scenario.lanes > LANE_COUNT) {
+            printf("%s: skipped, needs %u lanes (LANE_COUNT is %d)\n", scenario.name, scenario.lanes, LANE_COUNT);
+            continue;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        if (!Sim::run(scenario, result)) {
+            printf("%s: cycle %lu did not finish - machine stuck\n", scenario.name,
+                   (unsigned long)result.cycles + 1);
+            return 1;
+        }
+        const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+        report(scenario, result, wall.count());
+        collect(scenario, result, metrics);
+    }
+    if (metrics.empty()) {
+        fprintf(stderr, "No scenario named %s for %d lane(s)\n", only, LANE_COUNT);
+        return 2;
+    }
+
+    if (updateBaseline) {
+        if (!writeBaseline(baselinePath, metrics)) {
+            perror(baselinePath);
+            return 1;
+        }
+        printf("\nBaseline written to %s\n", baselinePath);
+        return 0;
+    }
+
+    int missing;
+    const int regressions = compare(baselinePath, metrics, thresholdPct, missing);
+    if (regressions) {
+        printf("\nBENCHMARK FAILED\n");
+        return 1;
+    }
+    if (missing) {
+        printf("\nBENCHMARK INCOMPLETE: %d metric(s) missing from the baseline\n", missing);
+        return 3;
+    }
+    printf("\nBENCHMARK PASSED\n");
+    return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * Native (Linux) runner for the router state machine.
+ *
+ * Builds the same state machine as the ESP32-S3 firmware against the
+ * simulated HAL backend, presses every lane's start sensor together, and
+ * steps virtual time one control tick at a time until the requested number
+ * of cycles has completed on every lane.
+ *
+ *   pio run -e native && .pio/build/native/program [cycles]
+ *
+ * Cycle telemetry is sent to 127.0.0.1, so tools/telemetry_receiver can
+ * watch the simulated machine.
+ *
+ * `pio test -e native` builds src/ with the unit tests (test/), which
+ * bring their own main(); this runner is left out of that build.
+ */
+
+#ifndef PIO_UNIT_TESTING
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "StateMachine/StateMachine.h"
+#include "LoopProfiler.h"
+#include "SerialCommands.h"
+#include "Telemetry.h"
+#include "TraceRing.h"
+
+// ************************************************************************
+// ************************* SIMULATION SETTINGS **************************
+// ************************************************************************
+const uint32_t TICK_US = 1000000UL / CONTROL_TICK_HZ;  // One control task tick
+const uint32_t START_PULSE_MS = 50;         // How long the simulated part holds the start sensor
+const uint32_t MAX_CYCLE_MS = 60000;        // Abort if one cycle takes longer than this
+const uint32_t NETWORK_POLL_TICKS = 10;     // Network task period, in control ticks
+
+// Run one control tick, exactly like the control task does on the target
+static void tick() {
+    hal::sim::advanceMicros(TICK_US);
+    const uint32_t startUs = hal::Clock::micros();
+    for (Lane& lane : lanes) {
+        PROFILE_SECTION(SEC_INPUTS, updateInputs(lane));
+        PROFILE_SECTION(SEC_STATE_MACHINE, handleStateMachine(lane));
+    }
+    LoopProfiler::recordIteration(LoopProfiler::LOOP_CONTROL, hal::Clock::micros() - startUs);
+    Logger::drain();
+
+    // Stand-in for the network task: batch telemetry to the loopback receiver
+    static uint32_t ticks = 0;
+    if (++ticks % NETWORK_POLL_TICKS == 0) Telemetry::poll(hal::Clock::millis());
+}
+
+// Present or remove a part at every lane's start sensor
+static void setStartSensors(bool level) {
+    for (const LanePins& pins : LANE_PINS) hal::sim::setInput(pins.startSensor, level);
+}
+
+static bool anyLaneIdle() {
+    for (const Lane& lane : lanes) {
+        if (lane.state == S_IDLE) return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    const int cycles = argc > 1 ? atoi(argv[1]) : 3;
+
+    hal::sim::reset();
+    Logger::init();
+    Params::init();
+    Telemetry::init(1, LANE_COUNT);
+    TraceRing::init(0);
+    initStateMachine();
+
+    uint32_t totalMs = 0;
+    for (int cycle = 1; cycle <= cycles; cycle++) {
+        const uint32_t cycleStart = hal::Clock::millis();
+
+        // Present a part to every lane
+        setStartSensors(true);
+        while (anyLaneIdle()) {
+            tick();
+            if (hal::Clock::millis() - cycleStart >= START_PULSE_MS) setStartSensors(false);
+            if (hal::Clock::millis() - cycleStart > MAX_CYCLE_MS) {
+                printf("Cycle %d did not start on every lane within %lu ms\n", cycle, (unsigned long)MAX_CYCLE_MS);
+                return 1;
+            }
+        }
+        setStartSensors(false);
+
+        // Run until every lane is back in IDLE
+        while (!allLanesIdle()) {
+            tick();
+            if (hal::Clock::millis() - cycleStart > MAX_CYCLE_MS) {
+                printf("Cycle %d did not return to IDLE within %lu ms\n", cycle, (unsigned long)MAX_CYCLE_MS);
+                return 1;
+            }
+        }
+
+        const uint32_t cycleMs = hal::Clock::millis() - cycleStart;
+        totalMs += cycleMs;
+        printf("Cycle %d complete in %lu ms\n", cycle, (unsigned long)cycleMs);
+
+        // Let the start input settle back to idle before the next part
+        for (uint32_t i = 0; i < MANUAL_START_DEBOUNCE_MS + START_SENSOR_DEBOUNCE_MS; i++) tick();
+    }
+
+    if (cycles > 0) {
+        printf("%d cycles, average %lu ms per cycle\n", cycles, (unsigned long)(totalMs / cycles));
+    }
+    // Give the last telemetry batch time to go out
+    for (uint32_t i = 0; i < Telemetry::FLUSH_MS * CONTROL_TICK_HZ / 1000; i++) tick();
+
+    LoopProfiler::publish(LoopProfiler::LOOP_CONTROL);   // Include the last partial second
+    SerialCommands::execute("stats");
+    return 0;
+}
+
+#endif // PIO_UNIT_TESTING
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "StateMachine/StateMachine.h"
+#include "Logger.h"
+
+// ************************************************************************
+// ************************* UNIT TEST HARNESS ****************************
+// ************************************************************************
+// Shared by the test programs in test/: a freshly initialised machine on
+// the simulated HAL, ticked the way the control task ticks it. Time only
+// moves inside tick(), so every run is repeatable.
+
+namespace TestSim {
+
+const uint32_t TICK_US = 1000000UL / CONTROL_TICK_HZ;
+
+// Power on: simulated pins low, default parameters, every lane in IDLE
+inline void begin() {
+    Serial.setQuiet(true);   // Keep the event log out of the test report
+    hal::sim::reset();
+    Logger::init();
+    Params::init();
+    initStateMachine();
+}
+
+// One control tick on every lane
+inline void tick() {
+    hal::sim::advanceMicros(TICK_US);
+    for (Lane& lane : lanes) {
+        updateInputs(lane);
+        handleStateMachine(lane);
+    }
+    Logger::drain();
+}
+
+inline void runMs(uint32_t ms) {
+    for (uint32_t i = 0; i < ms * CONTROL_TICK_HZ / 1000; i++) tick();
+}
+
+// Tick until `done()` holds; false if it still doesn't after `limitMs`
+template <typename Done>
+inline bool runUntil(Done done, uint32_t limitMs) {
+    for (uint32_t i = 0; i < limitMs * CONTROL_TICK_HZ / 1000; i++) {
+        if (done()) return true;
+        tick();
+    }
+    return done();
+}
+
+inline void setStartSensor(const Lane& lane, bool level) {
+    hal::sim::setInput(LANE_PINS[lane.id].startSensor, level);
+}
+
+// A part passing the start sensor: the sensor's edge, held for `holdMs`
+inline void pulseStartSensor(const Lane& lane, uint32_t holdMs) {
+    setStartSensor(lane, true);
+    runMs(holdMs);
+    setStartSensor(lane, false);
+}
+
+} // namespace TestSim
@@ -0,0 +1,213 @@
+// Jam and stall handling: how the step watchdog learns its deadlines, and
+// how a faulted lane retries, latches and is cleared.
+
+#include <unity.h>
+#include "../TestSim.h"
+
+const uint32_t CYCLE_LIMIT_MS = 60000;
+const int STEP = ST_FEED1_WAIT_STROKE;
+const uint32_t CEILING_MS = 3000;
+
+static Lane& lane = lanes[0];
+
+void setUp() {
+    TestSim::begin();
+}
+
+void tearDown() {
+    requestHold(HOLD_ARDUINO_OTA, false);
+    requestHold(HOLD_DELTA_OTA, false);
+}
+
+// ************************************************************************
+// ***************************** STEP WATCHDOG ****************************
+// ************************************************************************
+static uint32_t learnedDeadlineMs(uint32_t slowestMs) {
+    return (uint32_t)(slowestMs * WATCHDOG_FACTOR + WATCHDOG_MARGIN_MS);
+}
+
+static void test_watchdog_uses_ceiling_until_learned() {
+    StepWatchdog watchdog;
+    for (int i = 0; i < WATCHDOG_MIN_SAMPLES - 1; i++) watchdog.record(STEP, 1000000);
+    TEST_ASSERT_FALSE(watchdog.learned(STEP));
+    TEST_ASSERT_EQUAL(CEILING_MS, watchdog.deadlineMs(STEP, CEILING_MS));
+
+    watchdog.record(STEP, 1000000);
+    TEST_ASSERT_TRUE(watchdog.learned(STEP));
+    TEST_ASSERT_EQUAL(learnedDeadlineMs(1000), watchdog.deadlineMs(STEP, CEILING_MS));
+    TEST_ASSERT_FALSE(watchdog.learned(STEP + 1));   // Steps learn separately
+}
+
+static void test_watchdog_follows_slowest_recent_pass() {
+    StepWatchdog watchdog;
+    watchdog.record(STEP, 1200000);
+    for (int i = 0; i < StepWatchdog::HISTORY - 1; i++) watchdog.record(STEP, 1000000);
+    TEST_ASSERT_EQUAL(learnedDeadlineMs(1200), watchdog.deadlineMs(STEP, CEILING_MS));
+
+    watchdog.record(STEP, 1000000);   // The slow pass ages out
+    TEST_ASSERT_EQUAL(learnedDeadlineMs(1000), watchdog.deadlineMs(STEP, CEILING_MS));
+}
+
+static void test_watchdog_never_exceeds_ceiling() {
+    StepWatchdog watchdog;
+    for (int i = 0; i < WATCHDOG_MIN_SAMPLES; i++) watchdog.record(STEP, 2500000);
+    TEST_ASSERT_EQUAL(CEILING_MS, watchdog.deadlineMs(STEP, CEILING_MS));
+}
+
+static void test_watchdog_reset_and_bad_steps() {
+    StepWatchdog watchdog;
+    for (int i = 0; i < WATCHDOG_MIN_SAMPLES; i++) watchdog.record(STEP, 1000000);
+    watchdog.reset();
+    TEST_ASSERT_FALSE(watchdog.learned(STEP));
+    TEST_ASSERT_EQUAL(CEILING_MS, watchdog.deadlineMs(STEP, CEILING_MS));
+
+    watchdog.record(-1, 1000000);
+    watchdog.record(StepWatchdog::MAX_STEPS, 1000000);
+    TEST_ASSERT_FALSE(watchdog.learned(-1));
+    TEST_ASSERT_FALSE(watchdog.learned(StepWatchdog::MAX_STEPS));
+    TEST_ASSERT_EQUAL(CEILING_MS, watchdog.deadlineMs(StepWatchdog::MAX_STEPS, CEILING_MS));
+}
+
+// ************************************************************************
+// ****************************** LANE FAULTS *****************************
+// ************************************************************************
+static bool cylinderHigh() {
+    return hal::sim::getOutput(LANE_PINS[lane.id].feedCylinder);
+}
+
+static void startCycle() {
+    TestSim::pulseStartSensor(lane, 50);
+    TestSim::runMs(1000);
+    TEST_ASSERT_EQUAL(ST_FEED1_WAIT_STROKE, lane.step);
+    TEST_ASSERT_TRUE(cylinderHigh());
+}
+
+static void fault() {
+    raiseFault(lane, FAULT_FEED_JAM);
+    TestSim::tick();
+    TEST_ASSERT_EQUAL(S_FAULT, lane.state);
+    TEST_ASSERT_FALSE(cylinderHigh());
+}
+
+static void test_watchdog_faults_a_stalled_step() {
+    for (int cycle = 0; cycle < WATCHDOG_MIN_SAMPLES; cycle++) {
+        TestSim::pulseStartSensor(lane, 50);
+        TEST_ASSERT_TRUE(TestSim::runUntil([] { return lane.state == S_IDLE; }, CYCLE_LIMIT_MS));
+        TestSim::runMs(300);
+    }
+    TEST_ASSERT_TRUE(lane.watchdog.learned(ST_FEED1_WAIT_STROKE));
+
+    // The stroke now takes longer than any learned pass: a stall
+    lane.params.feedTime = 5000;
+    const uint32_t faultsBefore = lane.faults;
+    const uint32_t timeoutsBefore = lane.stepStats[ST_FEED1_WAIT_STROKE].timeouts;
+    startCycle();
+    TEST_ASSERT_TRUE(TestSim::runUntil([] { return lane.state == S_FAULT; }, CYCLE_LIMIT_MS));
+    TEST_ASSERT_EQUAL(1, lane.faults - faultsBefore);
+    TEST_ASSERT_EQUAL(1, lane.stepStats[ST_FEED1_WAIT_STROKE].timeouts - timeoutsBefore);
+    TEST_ASSERT_FALSE(cylinderHigh());
+}
+
+static void test_fault_retries_after_growing_delay() {
+    startCycle();
+    fault();
+
+    // Retry 1 after one delay: the part's cycle runs again
+    TestSim::runMs((uint32_t)FAULT_RETRY_DELAY_MS - 10);
+    TEST_ASSERT_EQUAL(S_FAULT, lane.state);
+    TestSim::runMs(20);
+    TEST_ASSERT_EQUAL(S_FEEDING, lane.state);
+    TEST_ASSERT_EQUAL(1, lane.faultRetries);
+
+    // Retry 2 waits twice as long
+    TestSim::runMs(1000);
+    fault();
+    TestSim::runMs(2 * (uint32_t)FAULT_RETRY_DELAY_MS - 10);
+    TEST_ASSERT_EQUAL(S_FAULT, lane.state);
+    TestSim::runMs(20);
+    TEST_ASSERT_EQUAL(S_FEEDING, lane.state);
+    TEST_ASSERT_EQUAL(2, lane.faultRetries);
+
+    // A cycle that completes resets the count
+    TEST_ASSERT_TRUE(TestSim::runUntil([] { return lane.state == S_IDLE; }, CYCLE_LIMIT_MS));
+    TEST_ASSERT_EQUAL(0, lane.faultRetries);
+}
+
+static void test_fault_latches_when_retries_run_out() {
+    startCycle();
+    for (int retry = 1; retry <= (int)FAULT_RETRIES; retry++) {
+        fault();
+        TEST_ASSERT_TRUE(TestSim::runUntil([] { return lane.state == S_FEEDING; }, CYCLE_LIMIT_MS));
+        TEST_ASSERT_EQUAL(retry, lane.faultRetries);
+    }
+
+    fault();
+    TestSim::runMs(CYCLE_LIMIT_MS);
+    TEST_ASSERT_EQUAL(S_FAULT, lane.state);
+    TEST_ASSERT_TRUE(laneRestMs(lane) == LANE_REST_FOREVER);   // Nothing left to wake for
+
+    // The operator's "clear" goes back to IDLE without starting a cycle
+    requestFaultClear(lane.id);
+    TestSim::tick();
+    TEST_ASSERT_EQUAL(S_IDLE, lane.state);
+    TEST_ASSERT_EQUAL(0, lane.faultRetries);
+    TEST_ASSERT_EQUAL(FAULT_NONE, lane.faultCause);
+    TestSim::runMs(1000);
+    TEST_ASSERT_EQUAL(S_IDLE, lane.state);
+}
+
+static void test_manual_start_clears_and_starts() {
+    lane.params.faultRetries = 0;   // Always wait for an operator
+    startCycle();
+    fault();
+    TestSim::runMs(CYCLE_LIMIT_MS);
+    TEST_ASSERT_EQUAL(S_FAULT, lane.state);
+
+    hal::sim::setInput(LANE_PINS[lane.id].manualStart, true);
+    TestSim::runMs(50);
+    hal::sim::setInput(LANE_PINS[lane.id].manualStart, false);
+    TEST_ASSERT_EQUAL(S_FEEDING, lane.state);
+    TEST_ASSERT_EQUAL(0, lane.faultRetries);
+}
+
+static void test_clear_before_fault_is_ignored() {
+    requestFaultClear(lane.id);   // Stale: not an acknowledgement of the next fault
+    startCycle();
+    lane.params.faultRetries = 0;
+    fault();
+    TestSim::runMs(1000);
+    TEST_ASSERT_EQUAL(S_FAULT, lane.state);
+}
+
+static void test_retry_waits_for_hold() {
+    startCycle();
+    fault();
+    requestHold(HOLD_ARDUINO_OTA, true);
+    requestHold(HOLD_DELTA_OTA, true);
+    TestSim::runMs(4 * (uint32_t)FAULT_RETRY_DELAY_MS);
+    TEST_ASSERT_EQUAL(S_FAULT, lane.state);
+
+    // Each owner releases only its own hold
+    requestHold(HOLD_DELTA_OTA, false);
+    TestSim::tick();
+    TEST_ASSERT_EQUAL(S_FAULT, lane.state);
+    requestHold(HOLD_ARDUINO_OTA, false);
+    TestSim::tick();
+    TEST_ASSERT_EQUAL(S_FEEDING, lane.state);
+    TEST_ASSERT_EQUAL(1, lane.faultRetries);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_watchdog_uses_ceiling_until_learned);
+    RUN_TEST(test_watchdog_follows_slowest_recent_pass);
+    RUN_TEST(test_watchdog_never_exceeds_ceiling);
+    RUN_TEST(test_watchdog_reset_and_bad_steps);
+    RUN_TEST(test_watchdog_faults_a_stalled_step);
+    RUN_TEST(test_fault_retries_after_growing_delay);
+    RUN_TEST(test_fault_latches_when_retries_run_out);
+    RUN_TEST(test_manual_start_clears_and_starts);
+    RUN_TEST(test_clear_before_fault_is_ignored);
+    RUN_TEST(test_retry_waits_for_hold);
+    return UNITY_END();
+}
@@ -0,0 +1,71 @@
+// Step table dispatch: a cycle walks STEP_TABLE row by row, and the lane's
+// cached state and step number always match the row it is on.
+
+#include <unity.h>
+#include "../TestSim.h"
+
+const uint32_t CYCLE_LIMIT_MS = 60000;
+
+static Lane& lane = lanes[0];
+
+void setUp() {
+    TestSim::begin();
+}
+
+void tearDown() {}
+
+static void test_starts_in_idle() {
+    TEST_ASSERT_EQUAL(ST_IDLE_WAIT_START, lane.step);
+    TEST_ASSERT_EQUAL(S_IDLE, lane.state);
+    TEST_ASSERT_FALSE(lane.triggers.pending());
+
+    TestSim::runMs(1000);   // Nothing on the sensor: nothing happens
+    TEST_ASSERT_EQUAL(ST_IDLE_WAIT_START, lane.step);
+}
+
+static void test_cycle_follows_table() {
+    TestSim::setStartSensor(lane, true);
+    StepId previous = lane.step;
+    int transitions = 0;
+    for (uint32_t ms = 0; ms < CYCLE_LIMIT_MS; ms++) {
+        TestSim::tick();
+        if (ms == 50) TestSim::setStartSensor(lane, false);
+
+        const StepDef& def = stepDef(lane.step);
+        TEST_ASSERT_EQUAL(def.state, lane.state);
+        TEST_ASSERT_EQUAL(def.number, lane.stepNumber);
+        if (lane.step == previous) continue;
+
+        TEST_ASSERT_EQUAL(stepDef(previous).next, lane.step);
+        previous = lane.step;
+        transitions++;
+        if (lane.step == ST_IDLE_WAIT_START) break;
+    }
+    TEST_ASSERT_EQUAL(ST_IDLE_WAIT_START, lane.step);
+    TEST_ASSERT_EQUAL(ST_FAULT_HOLD, transitions);   // Every step before FAULT, then IDLE again
+}
+
+// The lanes outlive setUp(), so count from where the previous test left off
+static void test_cycle_enters_each_step_once() {
+    uint32_t entriesBefore[ST_COUNT];
+    for (int step = 0; step < ST_COUNT; step++) entriesBefore[step] = lane.stepStats[step].entries;
+    const uint32_t cyclesBefore = lane.cycleTimeUs.count();
+
+    TestSim::pulseStartSensor(lane, 50);
+    TEST_ASSERT_TRUE(TestSim::runUntil([] { return lane.state != S_IDLE; }, CYCLE_LIMIT_MS));
+    TEST_ASSERT_TRUE(TestSim::runUntil([] { return lane.state == S_IDLE; }, CYCLE_LIMIT_MS));
+
+    for (int step = 0; step < ST_FAULT_HOLD; step++) {
+        TEST_ASSERT_EQUAL(1, lane.stepStats[step].entries - entriesBefore[step]);
+    }
+    TEST_ASSERT_EQUAL(0, lane.stepStats[ST_FAULT_HOLD].entries - entriesBefore[ST_FAULT_HOLD]);
+    TEST_ASSERT_EQUAL(1, lane.cycleTimeUs.count() - cyclesBefore);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_in_idle);
+    RUN_TEST(test_cycle_follows_table);
+    RUN_TEST(test_cycle_enters_each_step_once);
+    return UNITY_END();
+}
@@ -0,0 +1,223 @@
+// Start trigger latching: the queue's coalescing, depth and requeue rules,
+// and how the lane takes queued and level starts.
+
+#include <unity.h>
+#include "../TestSim.h"
+
+const uint32_t CYCLE_LIMIT_MS = 60000;
+
+static Lane& lane = lanes[0];
+
+static MachineParams queueParams() {
+    MachineParams p = Params::defaults();
+    p.triggerQueueDepth = 2;
+    p.triggerMinSpacing = 250;
+    return p;
+}
+
+static Trigger sensorEdge(uint32_t edgeUs) {
+    return { TRIGGER_SENSOR, true, edgeUs };
+}
+
+void setUp() {
+    TestSim::begin();
+}
+
+void tearDown() {
+    requestHold(HOLD_DELTA_OTA, false);
+}
+
+// ************************************************************************
+// ***************************** TRIGGER QUEUE ****************************
+// ************************************************************************
+static void test_queue_coalesces_close_edges() {
+    const MachineParams p = queueParams();
+    TriggerQueue queue;
+    TEST_ASSERT_TRUE(queue.latch(sensorEdge(1000000), p));
+    TEST_ASSERT_FALSE(queue.latch(sensorEdge(1000000 + 249999), p));   // Same part
+    TEST_ASSERT_TRUE(queue.latch(sensorEdge(1000000 + 250000), p));
+    TEST_ASSERT_EQUAL(2, queue.queued());
+    TEST_ASSERT_EQUAL(2, queue.latchedCount());
+    TEST_ASSERT_EQUAL(1, queue.coalescedCount());
+    TEST_ASSERT_EQUAL(0, queue.droppedCount());
+}
+
+static void test_queue_coalesces_across_clock_wrap() {
+    const MachineParams p = queueParams();
+    TriggerQueue queue;
+    TEST_ASSERT_TRUE(queue.latch(sensorEdge(0xFFFFFF00UL), p));
+    TEST_ASSERT_FALSE(queue.latch(sensorEdge(100), p));
+    TEST_ASSERT_EQUAL(1, queue.coalescedCount());
+}
+
+static void test_queue_drops_beyond_depth() {
+    const MachineParams p = queueParams();
+    TriggerQueue queue;
+    TEST_ASSERT_TRUE(queue.latch(sensorEdge(0), p));
+    TEST_ASSERT_TRUE(queue.latch(sensorEdge(300000), p));
+    TEST_ASSERT_FALSE(queue.latch(sensorEdge(600000), p));   // Full
+    TEST_ASSERT_EQUAL(2, queue.queued());
+    TEST_ASSERT_EQUAL(1, queue.droppedCount());
+
+    // The oldest part goes first; a slot frees up for the next edge
+    Trigger trigger;
+    TEST_ASSERT_TRUE(queue.pop(trigger));
+    TEST_ASSERT_EQUAL(0, trigger.edgeUs);
+    TEST_ASSERT_TRUE(queue.latch(sensorEdge(900000), p));
+    TEST_ASSERT_TRUE(queue.pop(trigger));
+    TEST_ASSERT_EQUAL(300000, trigger.edgeUs);
+    TEST_ASSERT_TRUE(queue.pop(trigger));
+    TEST_ASSERT_EQUAL(900000, trigger.edgeUs);
+    TEST_ASSERT_FALSE(queue.pop(trigger));
+    TEST_ASSERT_FALSE(queue.pending());
+}
+
+static void test_queue_depth_is_capped_at_capacity() {
+    MachineParams p = queueParams();
+    p.triggerQueueDepth = TriggerQueue::CAPACITY + 4;
+    TriggerQueue queue;
+    for (int i = 0; i < TriggerQueue::CAPACITY + 4; i++) queue.latch(sensorEdge(i * 300000), p);
+    TEST_ASSERT_EQUAL(TriggerQueue::CAPACITY, queue.queued());
+    TEST_ASSERT_EQUAL(4, queue.droppedCount());
+}
+
+static void test_requeue_goes_first_past_spacing_and_depth() {
+    const MachineParams p = queueParams();
+    TriggerQueue queue;
+    queue.latch(sensorEdge(0), p);
+    queue.latch(sensorEdge(300000), p);
+    TEST_ASSERT_TRUE(queue.requeue({ TRIGGER_RETRY, false, 300001 }));   // Beyond depth, within spacing
+    TEST_ASSERT_EQUAL(3, queue.queued());
+
+    Trigger trigger;
+    queue.pop(trigger);
+    TEST_ASSERT_EQUAL(TRIGGER_RETRY, trigger.source);
+    queue.pop(trigger);
+    TEST_ASSERT_EQUAL(0, trigger.edgeUs);
+}
+
+static void test_requeue_fails_only_when_full() {
+    TriggerQueue queue;
+    for (int i = 0; i < TriggerQueue::CAPACITY; i++) {
+        TEST_ASSERT_TRUE(queue.requeue({ TRIGGER_RETRY, false, 0 }));
+    }
+    TEST_ASSERT_FALSE(queue.requeue({ TRIGGER_RETRY, false, 0 }));
+    TEST_ASSERT_EQUAL(TriggerQueue::CAPACITY, queue.queued());
+    TEST_ASSERT_EQUAL(1, queue.droppedCount());
+}
+
+// ************************************************************************
+// *************************** LANE START RULES ***************************
+// ************************************************************************
+static bool runOneCycle() {
+    return TestSim::runUntil([] { return lane.state != S_IDLE; }, CYCLE_LIMIT_MS) &&
+           TestSim::runUntil([] { return lane.state == S_IDLE; }, CYCLE_LIMIT_MS);
+}
+
+// Start a cycle with a part, then run until the lane is mid-cycle
+static void startCycle() {
+    TestSim::pulseStartSensor(lane, 50);
+    TestSim::runMs(1000);
+    TEST_ASSERT_EQUAL(S_FEEDING, lane.state);
+}
+
+static void test_part_on_sensor_at_power_on_starts() {
+    TestSim::setStartSensor(lane, true);
+    initStateMachine();
+    TEST_ASSERT_EQUAL(1, lane.triggers.queued());
+
+    TestSim::tick();
+    TEST_ASSERT_EQUAL(S_FEEDING, lane.state);
+}
+
+static void test_mid_cycle_part_starts_next_cycle() {
+    startCycle();
+    TestSim::pulseStartSensor(lane, 50);
+    TEST_ASSERT_EQUAL(1, lane.triggers.queued());
+
+    // Straight from the end of the cycle into the next, no IDLE tick
+    TEST_ASSERT_TRUE(TestSim::runUntil([] { return lane.step == ST_FEED2_WAIT_STROKE; }, CYCLE_LIMIT_MS));
+    TEST_ASSERT_TRUE(TestSim::runUntil([] { return lane.step != ST_FEED2_WAIT_STROKE; }, CYCLE_LIMIT_MS));
+    TEST_ASSERT_EQUAL(S_FEEDING, lane.state);
+    TEST_ASSERT_FALSE(lane.triggers.pending());
+}
+
+static void test_mid_cycle_parts_beyond_depth_are_dropped() {
+    lane.params.triggerQueueDepth = 2;
+    startCycle();
+    const uint32_t droppedBefore = lane.triggers.droppedCount();
+    for (int part = 0; part < 3; part++) {
+        TestSim::pulseStartSensor(lane, 50);
+        TestSim::runMs(300);   // Past the minimum spacing
+    }
+    TEST_ASSERT_EQUAL(2, lane.triggers.queued());
+    TEST_ASSERT_EQUAL(1, lane.triggers.droppedCount() - droppedBefore);
+}
+
+static void test_coalesced_part_left_on_sensor_starts_at_idle() {
+    // A second part reaches the sensor right behind the first: its edge
+    // is within the spacing and coalesced, but it stays on the sensor
+    TestSim::pulseStartSensor(lane, 50);
+    TestSim::runMs(50);
+    const uint32_t coalescedBefore = lane.triggers.coalescedCount();
+    TestSim::setStartSensor(lane, true);
+    TestSim::runMs(50);
+    TEST_ASSERT_EQUAL(1, lane.triggers.coalescedCount() - coalescedBefore);
+    TEST_ASSERT_FALSE(lane.triggers.pending());
+
+    TEST_ASSERT_TRUE(TestSim::runUntil([] { return lane.state == S_IDLE; }, CYCLE_LIMIT_MS));
+    TestSim::runMs(2);
+    TEST_ASSERT_EQUAL(S_FEEDING, lane.state);
+    TEST_ASSERT_FALSE(lane.levelStartArmed);
+}
+
+static void test_level_start_needs_active_sensor() {
+    TestSim::setStartSensor(lane, true);
+    TestSim::runMs(50);
+    TEST_ASSERT_TRUE(runOneCycle());
+
+    // Still on the sensor at IDLE entry: another cycle for it
+    TestSim::runMs(2);
+    TEST_ASSERT_EQUAL(S_FEEDING, lane.state);
+    TEST_ASSERT_TRUE(TestSim::runUntil([] { return lane.state == S_IDLE; }, CYCLE_LIMIT_MS));
+    TestSim::runMs(2);
+    TEST_ASSERT_EQUAL(S_FEEDING, lane.state);   // Sensor still active: next IDLE entry again
+
+    TestSim::setStartSensor(lane, false);
+    TEST_ASSERT_TRUE(TestSim::runUntil([] { return lane.state == S_IDLE; }, CYCLE_LIMIT_MS));
+    TestSim::runMs(1000);
+    TEST_ASSERT_EQUAL(S_IDLE, lane.state);
+}
+
+static void test_level_start_waits_for_hold() {
+    TestSim::setStartSensor(lane, true);
+    TestSim::runMs(50);
+    TEST_ASSERT_EQUAL(S_FEEDING, lane.state);
+    requestHold(HOLD_DELTA_OTA, true);
+    TEST_ASSERT_TRUE(TestSim::runUntil([] { return lane.state == S_IDLE; }, CYCLE_LIMIT_MS));
+
+    TestSim::runMs(1000);
+    TEST_ASSERT_EQUAL(S_IDLE, lane.state);
+    TEST_ASSERT_TRUE(lane.levelStartArmed);
+
+    requestHold(HOLD_DELTA_OTA, false);
+    TestSim::runMs(2);
+    TEST_ASSERT_EQUAL(S_FEEDING, lane.state);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_queue_coalesces_close_edges);
+    RUN_TEST(test_queue_coalesces_across_clock_wrap);
+    RUN_TEST(test_queue_drops_beyond_depth);
+    RUN_TEST(test_queue_depth_is_capped_at_capacity);
+    RUN_TEST(test_requeue_goes_first_past_spacing_and_depth);
+    RUN_TEST(test_requeue_fails_only_when_full);
+    RUN_TEST(test_part_on_sensor_at_power_on_starts);
+    RUN_TEST(test_mid_cycle_part_starts_next_cycle);
+    RUN_TEST(test_mid_cycle_parts_beyond_depth_are_dropped);
+    RUN_TEST(test_coalesced_part_left_on_sensor_starts_at_idle);
+    RUN_TEST(test_level_start_needs_active_sensor);
+    RUN_TEST(test_level_start_waits_for_hold);
+    return UNITY_END();
+}
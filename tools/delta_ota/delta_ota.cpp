@@ -0,0 +1,344 @@
+/*
+ * Delta firmware updates for the router.
+ *
+ *   g++ -std=c++17 -O2 -Iinclude tools/delta_ota/delta_ota.cpp src/DeltaPatch.cpp -o delta_ota
+ *
+ *   ./delta_ota diff <old.bin> <new.bin> <patch>     Build a patch (old = image running on the device)
+ *   ./delta_ota apply <old.bin> <patch> <out.bin>    Apply into a simulated flash partition, as the device does
+ *   ./delta_ota send <patch> <device-ip> [port]      Stream a patch to the device's delta OTA port
+ *   ./delta_ota selftest                             Diff + apply synthetic images in random chunk sizes
+ *
+ * The old image must be the exact .bin the device is running
+ * (.pio/build/<env>/firmware.bin from that build); the device refuses a
+ * patch made against anything else.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "DeltaPatch.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+const uint16_t DELTA_OTA_PORT = 3233;
+
+static bool readFile(const char* path, Bytes& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t buffer[65536];
+    size_t n;
+    out.clear();
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) out.insert(out.end(), buffer, buffer + n);
+    fclose(f);
+    return true;
+}
+
+static bool writeFile(const char* path, const Bytes& data) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    const bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    return fclose(f) == 0 && ok;
+}
+
+static void putU32(Bytes& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void sha256(const Bytes& data, uint8_t digest[Sha256::DIGEST_SIZE]) {
+    Sha256 hash;
+    hash.update(data.data(), data.size());
+    hash.finish(digest);
+}
+
+// ************************************************************************
+// ******************************* DIFF ***********************************
+// ************************************************************************
+// Greedy block matching: every BLOCK-byte window of the old image is
+// indexed by hash; the new image is scanned for windows that also occur in
+// the old one, and each hit is extended as far as the bytes keep matching.
+// Firmware rebuilds shift code around, so the continuation of the previous
+// match is tried first. Anything unmatched goes out as INSERT literals.
+const size_t BLOCK = 16;
+const size_t MIN_COPY = 24;       // Shorter matches cost more as a COPY than as literals
+
+static uint64_t blockHash(const uint8_t* p) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < BLOCK; i++) h = (h ^ p[i]) * 1099511628211ULL;
+    return h;
+}
+
+static size_t matchLength(const Bytes& oldImage, size_t oldAt, const Bytes& newImage, size_t newAt) {
+    size_t n = 0;
+    while (oldAt + n < oldImage.size() && newAt + n < newImage.size() && oldImage[oldAt + n] == newImage[newAt + n]) n++;
+    return n;
+}
+
+static Bytes makePatch(const Bytes& oldImage, const Bytes& newImage) {
+    Bytes patch;
+    putU32(patch, PATCH_MAGIC);
+    patch.push_back(PATCH_VERSION);
+    patch.push_back(0);
+    patch.push_back(0);
+    patch.push_back(0);
+    putU32(patch, (uint32_t)oldImage.size());
+    putU32(patch, (uint32_t)newImage.size());
+    uint8_t digest[Sha256::DIGEST_SIZE];
+    sha256(oldImage, digest);
+    patch.insert(patch.end(), digest, digest + sizeof(digest));
+    sha256(newImage, digest);
+    patch.insert(patch.end(), digest, digest + sizeof(digest));
+
+    std::unordered_map<uint64_t, uint32_t> index;
+    if (oldImage.size() >= BLOCK) {
+        index.reserve(oldImage.size());
+        for (size_t i = 0; i + BLOCK <= oldImage.size(); i++) index.emplace(blockHash(&oldImage[i]), (uint32_t)i);
+    }
+
+    size_t literalStart = 0;
+    auto flushLiterals = [&](size_t end) {
+        if (end == literalStart) return;
+        patch.push_back(PATCH_INSERT);
+        putU32(patch, (uint32_t)(end - literalStart));
+        patch.insert(patch.end(), newImage.begin() + literalStart, newImage.begin() + end);
+    };
+
+    size_t nextOld = 0;    // Where the previous copy ended in the old image
+    size_t at = 0;
+    while (at < newImage.size()) {
+        size_t bestOld = 0;
+        size_t bestLength = matchLength(oldImage, nextOld, newImage, at);
+        if (bestLength) bestOld = nextOld;
+
+        if (bestLength < MIN_COPY && at + BLOCK <= newImage.size()) {
+            const auto hit = index.find(blockHash(&newImage[at]));
+            if (hit != index.end()) {
+                const size_t length = matchLength(oldImage, hit->second, newImage, at);
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestOld = hit->second;
+                }
+            }
+        }
+
+        if (bestLength < MIN_COPY) {
+            at++;
+            continue;
+        }
+        flushLiterals(at);
+        patch.push_back(PATCH_COPY);
+        putU32(patch, (uint32_t)bestOld);
+        putU32(patch, (uint32_t)bestLength);
+        at += bestLength;
+        nextOld = bestOld + bestLength;
+        literalStart = at;
+    }
+    flushLiterals(newImage.size());
+    patch.push_back(PATCH_END);
+    return patch;
+}
+
+// ************************************************************************
+// ************************ SIMULATED FLASH *******************************
+// ************************************************************************
+// Behaves like an OTA app partition: begin() erases whole 4 KB sectors,
+// writes are sequential and may only clear bits of erased flash, and
+// nothing may land past the partition.
+class SimulatedPartition : public PatchSource, public PatchSink {
+public:
+    static const size_t SECTOR = 4096;
+
+    explicit SimulatedPartition(size_t size) : flash(size, 0x00), writeAt(0), erasedTo(0), began(false) {}
+
+    Bytes flash;
+    size_t writeAt;
+    size_t erasedTo;
+    bool began;
+
+    bool read(uint32_t offset, uint8_t* data, size_t length) override {
+        if (offset > flash.size() || length > flash.size() - offset) return false;
+        memcpy(data, &flash[offset], length);
+        return true;
+    }
+
+    bool begin(uint32_t imageSize) override {
+        if (began || imageSize > flash.size()) return false;
+        erasedTo = (imageSize + SECTOR - 1) / SECTOR * SECTOR;
+        memset(flash.data(), 0xFF, erasedTo);
+        writeAt = 0;
+        began = true;
+        return true;
+    }
+
+    bool write(const uint8_t* data, size_t length) override {
+        if (!began || writeAt + length > erasedTo) return false;
+        for (size_t i = 0; i < length; i++) {
+            if ((flash[writeAt + i] & data[i]) != data[i]) return false;   // Would need a 0 -> 1 bit flip
+            flash[writeAt + i] &= data[i];
+        }
+        writeAt += length;
+        return true;
+    }
+};
+
+// Feed a patch in chunks; chunkSize 0 = random sizes from 1 to 1500
+static PatchApplier::Status applyPatch(SimulatedPartition& oldPart, SimulatedPartition& newPart,
+                                       const Bytes& patch, size_t chunkSize) {
+    PatchApplier applier(oldPart, newPart);
+    PatchApplier::Status status = PatchApplier::PATCH_NEED_MORE;
+    for (size_t at = 0; at < patch.size() && status == PatchApplier::PATCH_NEED_MORE;) {
+        size_t chunk = chunkSize ? chunkSize : 1 + (size_t)(rand() % 1500);
+        if (chunk > patch.size() - at) chunk = patch.size() - at;
+        status = applier.feed(&patch[at], chunk);
+        at += chunk;
+    }
+    return status;
+}
+
+// ************************************************************************
+// ****************************** COMMANDS ********************************
+// ************************************************************************
+static int cmdDiff(const char* oldPath, const char* newPath, const char* patchPath) {
+    Bytes oldImage, newImage;
+    if (!readFile(oldPath, oldImage) || !readFile(newPath, newImage)) {
+        perror("read");
+        return 1;
+    }
+    const Bytes patch = makePatch(oldImage, newImage);
+    if (!writeFile(patchPath, patch)) {
+        perror("write");
+        return 1;
+    }
+    printf("%zu -> %zu bytes, patch %zu bytes (%.1f%% of a full image)\n",
+           oldImage.size(), newImage.size(), patch.size(), 100.0 * patch.size() / (newImage.size() ? newImage.size() : 1));
+    return 0;
+}
+
+static int cmdApply(const char* oldPath, const char* patchPath, const char* outPath) {
+    Bytes oldImage, patch;
+    if (!readFile(oldPath, oldImage) || !readFile(patchPath, patch)) {
+        perror("read");
+        return 1;
+    }
+    SimulatedPartition running(oldImage.size());
+    running.flash = oldImage;
+    SimulatedPartition next(oldImage.size() * 2 + SimulatedPartition::SECTOR);
+
+    const PatchApplier::Status status = applyPatch(running, next, patch, 1460);
+    if (status != PatchApplier::PATCH_DONE) {
+        printf("apply failed: %s\n", PatchApplier::statusText(status));
+        return 1;
+    }
+    uint32_t newSize = 0;
+    for (int i = 0; i < 4; i++) newSize |= (uint32_t)patch[12 + i] << (8 * i);
+    const Bytes image(next.flash.begin(), next.flash.begin() + newSize);
+    if (!writeFile(outPath, image)) {
+        perror("write");
+        return 1;
+    }
+    printf("applied and verified: %u bytes\n", newSize);
+    return 0;
+}
+
+static int cmdSend(const char* patchPath, const char* host, uint16_t port) {
+    Bytes patch;
+    if (!readFile(patchPath, patch)) {
+        perror("read");
+        return 1;
+    }
+    const int sock = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in to = {};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &to.sin_addr) != 1 || connect(sock, (const sockaddr*)&to, sizeof(to)) < 0) {
+        perror("connect");
+        return 1;
+    }
+    for (size_t at = 0; at < patch.size();) {
+        const ssize_t n = send(sock, &patch[at], patch.size() - at, 0);
+        if (n <= 0) {
+            perror("send");
+            return 1;
+        }
+        at += (size_t)n;
+    }
+    shutdown(sock, SHUT_WR);
+
+    // The device answers with one status line once the image is verified
+    char reply[128];
+    const ssize_t n = recv(sock, reply, sizeof(reply) - 1, 0);
+    close(sock);
+    reply[n > 0 ? n : 0] = '\0';
+    printf("%s", n > 0 ? reply : "no reply from device\n");
+    return n > 0 && strncmp(reply, "OK", 2) == 0 ? 0 : 1;
+}
+
+// Synthetic "firmware": random code with a small edit that shifts everything after it
+static int cmdSelfTest() {
+    srand(12345);
+    Bytes oldImage(900 * 1024);
+    for (auto& b : oldImage) b = (uint8_t)rand();
+
+    Bytes newImage = oldImage;
+    newImage.insert(newImage.begin() + 300000, 64, 0xAB);            // Inserted function
+    for (size_t i = 500000; i < 500000 + 2000; i += 50) newImage[i] ^= 0x5A;   // Patched call sites
+    newImage.erase(newImage.begin() + 700000, newImage.begin() + 700100);      // Removed code
+    newImage.insert(newImage.end(), 4096, 0x11);                     // Grown data section
+
+    const Bytes patch = makePatch(oldImage, newImage);
+    printf("image %zu bytes, patch %zu bytes (%.2f%%)\n", newImage.size(), patch.size(),
+           100.0 * patch.size() / newImage.size());
+
+    bool ok = true;
+    const size_t chunkSizes[] = { 1, 7, 1460, 0, 0, 0 };
+    for (size_t chunkSize : chunkSizes) {
+        SimulatedPartition running(oldImage.size());
+        running.flash = oldImage;
+        SimulatedPartition next(2 * 1024 * 1024);
+        const PatchApplier::Status status = applyPatch(running, next, patch, chunkSize);
+        const bool match = status == PatchApplier::PATCH_DONE &&
+                           memcmp(next.flash.data(), newImage.data(), newImage.size()) == 0;
+        printf("  chunks of %-6s %s\n", chunkSize ? std::to_string(chunkSize).c_str() : "random",
+               match ? "ok" : PatchApplier::statusText(status));
+        ok = ok && match;
+    }
+
+    // Must refuse a patch for a different base, and a corrupted patch
+    SimulatedPartition wrongBase(oldImage.size());
+    wrongBase.flash = newImage;
+    wrongBase.flash.resize(oldImage.size());
+    SimulatedPartition target(2 * 1024 * 1024);
+    const bool refusedBase = applyPatch(wrongBase, target, patch, 1460) == PatchApplier::PATCH_WRONG_BASE && !target.began;
+    printf("  wrong base image  %s\n", refusedBase ? "refused" : "NOT REFUSED");
+
+    Bytes corrupt = patch;
+    corrupt[corrupt.size() - 100] ^= 0xFF;    // Inside the last literal run
+    SimulatedPartition running(oldImage.size());
+    running.flash = oldImage;
+    SimulatedPartition next(2 * 1024 * 1024);
+    const bool refusedCorrupt = applyPatch(running, next, corrupt, 1460) == PatchApplier::PATCH_HASH_MISMATCH;
+    printf("  corrupted patch   %s\n", refusedCorrupt ? "refused" : "NOT REFUSED");
+
+    ok = ok && refusedBase && refusedCorrupt && patch.size() < newImage.size() / 50;
+    printf("selftest %s\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 5 && strcmp(argv[1], "diff") == 0) return cmdDiff(argv[2], argv[3], argv[4]);
+    if (argc >= 5 && strcmp(argv[1], "apply") == 0) return cmdApply(argv[2], argv[3], argv[4]);
+    if (argc >= 4 && strcmp(argv[1], "send") == 0) {
+        return cmdSend(argv[2], argv[3], argc >= 5 ? (uint16_t)atoi(argv[4]) : DELTA_OTA_PORT);
+    }
+    if (argc >= 2 && strcmp(argv[1], "selftest") == 0) return cmdSelfTest();
+
+    fprintf(stderr, "usage: %s diff <old.bin> <new.bin> <patch> | apply <old.bin> <patch> <out.bin> |"
+                    " send <patch> <device-ip> [port] | selftest\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,262 @@
+/*
+ * Host-side receiver for the router's UDP cycle telemetry.
+ *
+ * Listens on TELEMETRY_PORT for datagrams from any number of machines and
+ * prints, per machine, parts/hour and cycle-time and start-latency
+ * percentiles every few seconds.
+ *
+ *   g++ -std=c++17 -O2 -Iinclude tools/telemetry_receiver/telemetry_receiver.cpp -o telemetry_receiver
+ *
+ *   ./telemetry_receiver                 Receive and report until interrupted
+ *   ./telemetry_receiver --send N        Send N synthetic cycles to 127.0.0.1
+ *   ./telemetry_receiver --selftest      Loopback send + receive, exit 0 if every record arrived intact
+ *
+ * The native simulator (pio run -e native) also sends to 127.0.0.1.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include "TelemetryProtocol.h"
+#include "Histogram.h"
+
+// ************************************************************************
+// ***************************** AGGREGATION ******************************
+// ************************************************************************
+struct Machine {
+    uint32_t bootId = 0;
+    uint32_t records = 0;
+    uint32_t lost = 0;             // Sequence gaps seen by the receiver
+    uint32_t deviceDropped = 0;    // As reported by the device
+    uint32_t faults = 0;
+    uint32_t timeouts = 0;
+    uint32_t sensorStarts = 0;
+    uint32_t manualStarts = 0;
+    uint32_t retryStarts = 0;      // Cycles re-run after a fault
+    uint32_t lastSequence = 0;
+    uint32_t firstEndMs = 0;
+    uint32_t lastEndMs = 0;
+    Histogram cycleUs;
+    Histogram startLatencyUs;
+
+    void add(const TelemetryHeader& header, const TelemetryRecord& r) {
+        if (header.bootId != bootId) {
+            *this = Machine();     // Rebooted: start over
+            bootId = header.bootId;
+        }
+        if (records > 0 && r.sequence <= lastSequence) return;   // Duplicate or reordered
+        if (records > 0 && r.sequence > lastSequence + 1) lost += r.sequence - lastSequence - 1;
+        if (records == 0) firstEndMs = r.endMs;
+
+        records++;
+        lastSequence = r.sequence;
+        lastEndMs = r.endMs;
+        deviceDropped = header.droppedRecords;
+        cycleUs.record(r.cycleUs);
+        if (r.startLatencyUs) startLatencyUs.record(r.startLatencyUs);
+        if (r.flags & TELEMETRY_FLAG_FAULT) faults++;
+        if (r.flags & TELEMETRY_FLAG_STEP_TIMEOUT) timeouts++;
+        if (r.trigger == TRIGGER_SENSOR) sensorStarts++;
+        if (r.trigger == TRIGGER_MANUAL) manualStarts++;
+        if (r.trigger == TRIGGER_RETRY) retryStarts++;
+    }
+
+    // Completed cycles per hour of device time between the first and last record
+    double partsPerHour() const {
+        const uint32_t spanMs = lastEndMs - firstEndMs;
+        if (records < 2 || spanMs == 0) return 0.0;
+        return (records - 1) * 3600000.0 / spanMs;
+    }
+
+    void print(const std::string& name) const {
+        printf("%s  boot %08x  %u cycles  %.1f parts/h  lost %u  device dropped %u  faults %u  timeouts %u  (sensor %u / manual %u / retry %u)\n",
+               name.c_str(), bootId, records, partsPerHour(), lost, deviceDropped, faults, timeouts,
+               sensorStarts, manualStarts, retryStarts);
+        printf("    cycle ms     p50 %8.1f  p95 %8.1f  p99 %8.1f  max %8.1f\n",
+               cycleUs.percentile(500) / 1000.0, cycleUs.percentile(950) / 1000.0,
+               cycleUs.percentile(990) / 1000.0, cycleUs.max() / 1000.0);
+        printf("    latency us   p50 %8u  p95 %8u  p99 %8u  max %8u\n",
+               startLatencyUs.percentile(500), startLatencyUs.percentile(950),
+               startLatencyUs.percentile(990), startLatencyUs.max());
+    }
+};
+
+static std::map<std::string, Machine> machines;
+
+static uint64_t nowMs() {
+    timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+static int openReceiver(uint16_t port) {
+    const int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) return -1;
+    const int yes = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    timeval timeout = { 0, 200000 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(sock, (const sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+// Wait up to ~200 ms for one datagram and fold it in; false on timeout
+static bool receiveOne(int sock, uint32_t& badDatagrams) {
+    uint8_t buffer[2048];
+    sockaddr_in from = {};
+    socklen_t fromLength = sizeof(from);
+    const ssize_t length = recvfrom(sock, buffer, sizeof(buffer), 0, (sockaddr*)&from, &fromLength);
+    if (length <= 0) return false;
+
+    TelemetryHeader header;
+    TelemetryRecord records[TELEMETRY_MAX_RECORDS];
+    if (!TelemetryWire::decode(buffer, (size_t)length, header, records, TELEMETRY_MAX_RECORDS)) {
+        badDatagrams++;
+        return true;
+    }
+
+    // Each lane numbers its cycles separately, so it is tracked as its own machine
+    char address[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &from.sin_addr, address, sizeof(address));
+    for (int i = 0; i < header.recordCount; i++) {
+        char name[INET_ADDRSTRLEN + 16];
+        if (header.laneCount > 1) snprintf(name, sizeof(name), "%s lane %u", address, records[i].lane);
+        else snprintf(name, sizeof(name), "%s", address);
+        machines[name].add(header, records[i]);
+    }
+    return true;
+}
+
+// ************************************************************************
+// ************************** LOOPBACK SENDER *****************************
+// ************************************************************************
+// Deterministic synthetic cycles: ~5.9 s with a little spread, every 10th
+// started manually, every 50th with a step timeout
+static TelemetryRecord syntheticRecord(uint32_t sequence) {
+    TelemetryRecord r = {};
+    const uint32_t spreadUs = (sequence * 7919) % 200000;
+    r.sequence = sequence;
+    r.cycleUs = 5800000 + spreadUs;
+    r.endMs = sequence * 6000;
+    r.startLatencyUs = 20 + (sequence * 31) % 400;
+    r.trigger = sequence % 10 == 0 ? TRIGGER_MANUAL : TRIGGER_SENSOR;
+    r.flags = sequence % 50 == 0 ? TELEMETRY_FLAG_STEP_TIMEOUT : 0;
+    r.stepCount = 9;
+    r.stepUs[1] = 400000;
+    r.stepUs[2] = 2500000;
+    r.stepUs[8] = 2500000;
+    return r;
+}
+
+static bool sendSynthetic(uint16_t port, uint32_t count, uint32_t bootId) {
+    const int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) return false;
+    sockaddr_in to = {};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(port);
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    TelemetryRecord batch[TELEMETRY_MAX_RECORDS];
+    uint8_t datagram[TELEMETRY_DATAGRAM_MAX];
+    for (uint32_t next = 1; next <= count;) {
+        TelemetryHeader header = {};
+        header.bootId = bootId;
+        header.laneCount = 1;
+        while (header.recordCount < TELEMETRY_MAX_RECORDS && next <= count) {
+            batch[header.recordCount++] = syntheticRecord(next++);
+        }
+        const size_t length = TelemetryWire::encode(datagram, sizeof(datagram), header, batch);
+        if (sendto(sock, datagram, length, 0, (const sockaddr*)&to, sizeof(to)) != (ssize_t)length) {
+            close(sock);
+            return false;
+        }
+        usleep(1000);
+    }
+    close(sock);
+    return true;
+}
+
+// ************************************************************************
+// ******************************** MAIN **********************************
+// ************************************************************************
+static int selfTest(uint16_t port) {
+    const uint32_t COUNT = 1000;
+    const int sock = openReceiver(port);
+    if (sock < 0) {
+        perror("bind");
+        return 1;
+    }
+    if (!sendSynthetic(port, COUNT, 0x5e1f7e57)) {
+        perror("sendto");
+        return 1;
+    }
+
+    uint32_t bad = 0;
+    while (receiveOne(sock, bad)) {}
+    close(sock);
+
+    uint32_t expectedMaxUs = 0;
+    for (uint32_t i = 1; i <= COUNT; i++) {
+        const uint32_t cycleUs = syntheticRecord(i).cycleUs;
+        if (cycleUs > expectedMaxUs) expectedMaxUs = cycleUs;
+    }
+
+    const Machine& m = machines["127.0.0.1"];
+    m.print("127.0.0.1");
+    const uint32_t p50 = m.cycleUs.percentile(500);
+    const bool ok = bad == 0 && m.records == COUNT && m.lost == 0 &&
+                    m.manualStarts == COUNT / 10 && m.timeouts == COUNT / 50 &&
+                    m.partsPerHour() > 599.0 && m.partsPerHour() < 601.0 &&
+                    m.cycleUs.max() == expectedMaxUs && p50 > 5850000 && p50 < 5950000;
+    printf("selftest %s\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    uint16_t port = TELEMETRY_PORT;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) port = (uint16_t)atoi(argv[++i]);
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--selftest") == 0) return selfTest(port);
+        if (strcmp(argv[i], "--send") == 0 && i + 1 < argc) {
+            return sendSynthetic(port, (uint32_t)atoi(argv[i + 1]), (uint32_t)nowMs()) ? 0 : 1;
+        }
+    }
+
+    const int sock = openReceiver(port);
+    if (sock < 0) {
+        perror("bind");
+        return 1;
+    }
+    printf("Listening for router telemetry on UDP %u\n", (unsigned)port);
+    fflush(stdout);
+
+    const uint64_t REPORT_MS = 5000;
+    uint64_t lastReport = nowMs();
+    uint32_t bad = 0;
+    for (;;) {
+        receiveOne(sock, bad);
+        if (nowMs() - lastReport >= REPORT_MS) {
+            lastReport = nowMs();
+            for (const auto& entry : machines) entry.second.print(entry.first);
+            if (bad) printf("(%u malformed datagrams ignored)\n", bad);
+            fflush(stdout);
+        }
+    }
+}